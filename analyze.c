@@ -0,0 +1,227 @@
+#include "analyze.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef struct AnalyzeJob
+{
+    int fd;
+    uint64_t first; // first record index
+    uint64_t count; // number of records
+    bool failed;
+    OutcomeTable *outcomes; // this thread's own, NULL if not collected
+    AnalyzeTable table;
+} AnalyzeJob;
+
+static void add_record(AnalyzeTable *table, const GameLogRecord *record)
+{
+    if (record->player_total >= ANALYZE_TOTALS || record->soft > 1
+        || record->dealer_upcard >= ANALYZE_UPCARDS || record->action >= ANALYZE_ACTIONS)
+    {
+        table->skipped++;
+        return;
+    }
+
+    AnalyzeCell *cell = &table->cells[record->player_total][record->soft][record->dealer_upcard][record->action];
+    cell->decisions++;
+    cell->stake += record->stake;
+    cell->net += record->net;
+}
+
+// streams a record range through a sliding mmap window,
+// so a chunk never needs to fit in memory as a whole
+static void *analyze_chunk(void *arg)
+{
+    AnalyzeJob *job = arg;
+    const uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t start = GAME_LOG_HEADER_SIZE + job->first * sizeof(GameLogRecord);
+    const uint64_t end = start + job->count * sizeof(GameLogRecord);
+
+    while (start < end)
+    {
+        uint64_t mapStart = start - start % pageSize;
+        uint64_t mapEnd = mapStart + ANALYZE_WINDOW_SIZE;
+        if (mapEnd > end) mapEnd = end;
+        // only whole records are taken from a window
+        uint64_t windowEnd = start + (mapEnd - start) / sizeof(GameLogRecord) * sizeof(GameLogRecord);
+
+        size_t mapLength = mapEnd - mapStart;
+        unsigned char *map = mmap(NULL, mapLength, PROT_READ, MAP_PRIVATE, job->fd, (off_t)mapStart);
+        if (map == MAP_FAILED)
+        {
+            job->failed = true;
+            return NULL;
+        }
+
+        madvise(map, mapLength, MADV_SEQUENTIAL);
+
+        for (uint64_t offset = start; offset < windowEnd; offset += sizeof(GameLogRecord))
+        {
+            GameLogRecord record;
+            memcpy(&record, map + (offset - mapStart), sizeof(record));
+            add_record(&job->table, &record);
+            if (job->outcomes != NULL)
+            {
+                outcome_table_add(job->outcomes, record.player_total, record.soft, record.dealer_upcard,
+                    record.action, (RoundOutcome)record.outcome, record.dealer_total);
+            }
+        }
+
+        munmap(map, mapLength);
+        start = windowEnd;
+    }
+
+    return NULL;
+}
+
+bool analyze_file(const char *path, AnalyzeTable *table, OutcomeTable *outcomes)
+{
+    struct stat info;
+    unsigned char header[GAME_LOG_HEADER_SIZE];
+    bool ok = true;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    if (fstat(fd, &info) != 0 || pread(fd, header, sizeof(header), 0) != sizeof(header)
+        || !game_log_check_header(header, sizeof(header)))
+    {
+        close(fd);
+        return false;
+    }
+
+    // a torn record at the tail (crash mid-append) is ignored
+    uint64_t records = ((uint64_t)info.st_size - GAME_LOG_HEADER_SIZE) / sizeof(GameLogRecord);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t threadCount = cores > 0 ? (uint64_t)cores : 1;
+    if (threadCount > records) threadCount = records > 0 ? records : 1;
+
+    AnalyzeJob *jobs = calloc(threadCount, sizeof(AnalyzeJob));
+    pthread_t *threads = calloc(threadCount, sizeof(pthread_t));
+
+    for (uint64_t i = 0; i < threadCount; i++)
+    {
+        jobs[i].fd = fd;
+        jobs[i].first = records * i / threadCount;
+        jobs[i].count = records * (i + 1) / threadCount - jobs[i].first;
+        jobs[i].outcomes = outcomes != NULL ? outcome_table_new() : NULL;
+        pthread_create(&threads[i], NULL, analyze_chunk, &jobs[i]);
+    }
+
+    // merge the per-thread tables
+    for (uint64_t i = 0; i < threadCount; i++)
+    {
+        pthread_join(threads[i], NULL);
+        ok = ok && !jobs[i].failed;
+
+        AnalyzeCell *src = &jobs[i].table.cells[0][0][0][0];
+        AnalyzeCell *dst = &table->cells[0][0][0][0];
+        for (size_t cell = 0; cell < sizeof(table->cells) / sizeof(AnalyzeCell); cell++)
+        {
+            dst[cell].decisions += src[cell].decisions;
+            dst[cell].stake += src[cell].stake;
+            dst[cell].net += src[cell].net;
+        }
+        table->skipped += jobs[i].table.skipped;
+
+        if (jobs[i].outcomes != NULL)
+        {
+            outcome_table_merge(outcomes, jobs[i].outcomes);
+            free(jobs[i].outcomes);
+        }
+    }
+
+    free(threads);
+    free(jobs);
+    close(fd);
+
+    return ok;
+}
+
+int analyze_main(int argc, char *argv[])
+{
+    static const char *action_names[ANALYZE_ACTIONS] = { "hit", "stand" };
+
+    const char *outcomesPath = NULL;
+    OutcomeTable *outcomes = NULL;
+    int files = 0;
+
+    AnalyzeTable *table = calloc(1, sizeof(AnalyzeTable));
+
+    // options first, they apply to every log
+    for (int i = 0; i + 1 < argc; i++)
+    {
+        if (strcmp("--outcomes", argv[i]) == 0) outcomesPath = argv[i + 1];
+    }
+
+    if (outcomesPath != NULL) outcomes = outcome_table_new();
+
+    for (int i = 0; i < argc; i++)
+    {
+        if (strcmp("--outcomes", argv[i]) == 0 && i + 1 < argc)
+        {
+            i++;
+            continue;
+        }
+
+        if (!analyze_file(argv[i], table, outcomes))
+        {
+            fprintf(stderr, "Failed to analyze '%s'.\n", argv[i]);
+            free(outcomes);
+            free(table);
+            return 1;
+        }
+        files++;
+    }
+
+    if (files == 0)
+    {
+        printf("Usage: prog analyze <log file>... [--outcomes <outcome file>]\n");
+        free(outcomes);
+        free(table);
+        return 1;
+    }
+
+    if (outcomesPath != NULL && !outcome_table_merge_file(outcomes, outcomesPath))
+    {
+        fprintf(stderr, "Could not write outcome table '%s'.\n", outcomesPath);
+    }
+
+    // EV is the player's net result per unit of pot
+    printf("total,soft,upcard,action,decisions,stake,net,ev\n");
+
+    for (int total = 0; total < ANALYZE_TOTALS; total++)
+    {
+        for (int soft = 0; soft < 2; soft++)
+        {
+            for (int upcard = 0; upcard < ANALYZE_UPCARDS; upcard++)
+            {
+                for (int action = 0; action < ANALYZE_ACTIONS; action++)
+                {
+                    AnalyzeCell *cell = &table->cells[total][soft][upcard][action];
+                    if (cell->decisions == 0) continue;
+
+                    printf("%d,%d,%d,%s,%llu,%llu,%lld,%.4f\n", total, soft, upcard, action_names[action],
+                        (unsigned long long)cell->decisions, (unsigned long long)cell->stake,
+                        (long long)cell->net, cell->stake ? (double)cell->net / cell->stake : 0.0);
+                }
+            }
+        }
+    }
+
+    if (table->skipped)
+    {
+        fprintf(stderr, "Skipped %llu malformed records.\n", (unsigned long long)table->skipped);
+    }
+
+    free(outcomes);
+    free(table);
+
+    return 0;
+}
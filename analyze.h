@@ -0,0 +1,41 @@
+#ifndef ANALYZE_H
+#define ANALYZE_H
+
+    #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#define _GNU_SOURCE
+    #endif
+
+#include <stdint.h>
+#include "game_log.h"
+#include "outcome_table.h"
+
+// table dimensions, indexed directly by record fields
+#define ANALYZE_TOTALS (32)
+#define ANALYZE_UPCARDS (11)
+#define ANALYZE_ACTIONS (2)
+// bytes of a log each thread maps at a time
+#define ANALYZE_WINDOW_SIZE ((size_t)64 << 20)
+
+typedef struct AnalyzeCell
+{
+    uint64_t decisions;
+    uint64_t stake;
+    int64_t net;
+} AnalyzeCell;
+
+// aggregation keyed by (player total, soft, dealer upcard, action)
+typedef struct AnalyzeTable
+{
+    AnalyzeCell cells[ANALYZE_TOTALS][2][ANALYZE_UPCARDS][ANALYZE_ACTIONS];
+    uint64_t skipped; // records with out of range fields
+} AnalyzeTable;
+
+// ** ANALYZE FUNCTIONS **
+// scans one log file with all cores, adding its records to table
+// and, if not NULL, to outcomes
+bool analyze_file(const char *path, AnalyzeTable *table, OutcomeTable *outcomes);
+// "analyze" subcommand: scans the given logs & prints the EV table,
+// optionally adding their per-state outcomes to an outcome table file
+int analyze_main(int argc, char *argv[]);
+
+#endif
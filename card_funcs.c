@@ -78,6 +78,39 @@ Card* cardlist_draw(CardList *list, uint8_t element)
     return out;
 }
 
+void cardlist_shuffle(CardList *list, uint64_t *rngState)
+{
+    // card lists are indexed by uint8_t elsewhere too
+    Card *cards[256];
+    size_t length = list->length;
+
+    if (length < 2 || length > 256) return;
+
+    Card *current = list->head;
+    for (size_t i = 0; i < length; i++)
+    {
+        cards[i] = current;
+        current = current->next;
+    }
+
+    for (size_t i = length - 1; i > 0; i--)
+    {
+        size_t j = rng_range(rngState, (uint32_t)(i + 1));
+        Card *swap = cards[i];
+        cards[i] = cards[j];
+        cards[j] = swap;
+    }
+
+    for (size_t i = 0; i + 1 < length; i++)
+    {
+        cards[i]->next = cards[i + 1];
+    }
+
+    cards[length - 1]->next = NULL;
+    list->head = cards[0];
+    list->tail = cards[length - 1];
+}
+
 void cardlist_free(CardList *list)
 {
     while(list->length > 0)
@@ -85,3 +118,28 @@ void cardlist_free(CardList *list)
         free(cardlist_pop(list));
     }
 }
+
+uint8_t cardlist_value(const CardList *list, bool *soft)
+{
+    uint16_t total = 0;
+    uint8_t aces = 0;
+    bool isSoft = false;
+
+    for (Card *current = list->head; current != NULL; current = current->next)
+    {
+        const CardInfo *info = &card_table[current->data];
+        if (info->rank == 0) aces++;
+        total += info->value;
+    }
+
+    while(total < 13 && aces > 0)
+    {
+        total += 9;
+        aces--;
+        isSoft = true;
+    }
+
+    if (soft != NULL) *soft = isSoft;
+
+    return total > 255 ? 255 : total;
+}
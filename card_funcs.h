@@ -2,7 +2,14 @@
 #define CARD_FUNCS_H
 
 #include <stdlib.h>
+#include <stdbool.h>
 #include "card_structs.h"
+#include "rng.h"
+
+// ** CARD TABLE **
+// indexed by Card.data, generated at build time by tools/gen_card_table.c.
+// entries for bytes that aren't valid cards are all zero.
+extern const CardInfo card_table[256];
 
 // ** CARD LIST FUNCTIONS **
 // initializes an empty card list
@@ -13,7 +20,13 @@ void cardlist_add(CardList *list, Card *newCard);
 Card* cardlist_pop(CardList *list);
 // detaches and returns the specified element of card list
 Card* cardlist_draw(CardList *list, uint8_t element);
+// shuffles a card list in place (Fisher-Yates) by relinking its cards,
+// so that cards can then be dealt straight off the head
+void cardlist_shuffle(CardList *list, uint64_t *rngState);
 // deallocates all cards of a card list
 void cardlist_free(CardList *list);
+// blackjack value of a card list, using the same ace rule as show_hand.
+// soft is set if an ace is being counted high (may be NULL).
+uint8_t cardlist_value(const CardList *list, bool *soft);
 
 #endif
@@ -17,4 +17,14 @@ typedef struct CardList
     size_t length;
 } CardList;
 
+// pre-rendered card, see card_table in card_funcs.h
+typedef struct CardInfo
+{
+    char text[32];
+    uint8_t length;
+    uint8_t value;
+    uint8_t rank;
+    uint8_t suit;
+} CardInfo;
+
 #endif
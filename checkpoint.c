@@ -0,0 +1,130 @@
+#include "checkpoint.h"
+
+#include "card_funcs.h"
+#include "outcome_table.h"
+#include "util.h"
+
+// magic + version + rng + cash + pot + 3 list lengths + 52 cards
+// + outcome table + checksum
+#define CHECKPOINT_MAX_SIZE (4 + 1 + 8 + 4 + 4 + 3 + 52 + OUTCOME_ENCODED_MAX_SIZE + 4)
+// the same, with no outcome counts
+#define CHECKPOINT_MIN_SIZE (4 + 1 + 8 + 4 + 4 + 3 + 4 + 4)
+
+static const char checkpoint_magic[4] = { 'B', 'J', 'C', 'K' };
+
+static size_t put_list(uint8_t *buf, const CardList *list)
+{
+    size_t offset = 0;
+    buf[offset++] = (uint8_t)list->length;
+    for (Card *current = list->head; current != NULL; current = current->next)
+    {
+        buf[offset++] = current->data;
+    }
+    return offset;
+}
+
+bool checkpoint_save(const GameData *gameData, const char *path)
+{
+    static uint8_t buf[CHECKPOINT_MAX_SIZE];
+    size_t size = 0;
+
+    if (gameData->deck.length + gameData->player_hand.length + gameData->dealer_hand.length > 52) return false;
+
+    memcpy(buf, checkpoint_magic, sizeof(checkpoint_magic));
+    size += sizeof(checkpoint_magic);
+    buf[size++] = CHECKPOINT_VERSION;
+    size += put_uint(buf + size, gameData->rng_state, 8);
+    size += put_uint(buf + size, gameData->cash, 4);
+    size += put_uint(buf + size, gameData->pot, 4);
+    size += put_list(buf + size, &gameData->deck);
+    size += put_list(buf + size, &gameData->player_hand);
+    size += put_list(buf + size, &gameData->dealer_hand);
+    // outcome counts so far, so a resumed game ends with the same table
+    if (gameData->outcomes != NULL) size += outcome_table_encode(gameData->outcomes, buf + size);
+    else size += put_uint(buf + size, 0, 4);
+    size += put_uint(buf + size, fnv1a(buf, size), 4);
+
+    return write_file_atomic(path, buf, size);
+}
+
+bool checkpoint_load(GameData *gameData, const char *path)
+{
+    static uint8_t buf[CHECKPOINT_MAX_SIZE + 1];
+    uint8_t seen[256] = { 0 };
+    size_t size = 0;
+    size_t offset = 0;
+    size_t cardCount = 0;
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return false;
+    size = fread(buf, 1, sizeof(buf), file);
+    fclose(file);
+
+    // smallest valid file: header, three empty lists, empty table & checksum
+    if (size < CHECKPOINT_MIN_SIZE || size > CHECKPOINT_MAX_SIZE) return false;
+    if (memcmp(buf, checkpoint_magic, sizeof(checkpoint_magic)) != 0) return false;
+    if (buf[4] != CHECKPOINT_VERSION) return false;
+    if (get_uint(buf + size - 4, 4) != fnv1a(buf, size - 4)) return false;
+
+    // validate the three card lists before touching game state
+    offset = 4 + 1 + 8 + 4 + 4;
+    for (int list = 0; list < 3; list++)
+    {
+        if (offset >= size - 4) return false;
+        uint8_t length = buf[offset++];
+        if (offset + length > size - 4) return false;
+
+        for (uint8_t i = 0; i < length; i++)
+        {
+            uint8_t data = buf[offset + i];
+            uint8_t suit_bits = data & 0x0F;
+            // rank must be 0-12 and exactly one suit bit set, no duplicates
+            if ((data >> 4) > 12 || suit_bits == 0 || (suit_bits & (suit_bits - 1)) != 0 || seen[data]) return false;
+            seen[data] = 1;
+        }
+
+        offset += length;
+        cardCount += length;
+    }
+
+    if (cardCount != 52) return false;
+
+    OutcomeTable *outcomes = outcome_table_new();
+    if (outcomes == NULL) return false;
+
+    if (outcome_table_decode(outcomes, buf + offset, size - 4 - offset) != size - 4 - offset)
+    {
+        free(outcomes);
+        return false;
+    }
+
+    // a game resumed without --outcomes has nowhere to keep the counts
+    if (gameData->outcomes != NULL) memcpy(gameData->outcomes, outcomes, sizeof(OutcomeTable));
+    free(outcomes);
+
+    gameData->rng_state = get_uint(buf + 5, 8);
+    gameData->cash = (uint32_t)get_uint(buf + 13, 4);
+    gameData->pot = (uint32_t)get_uint(buf + 17, 4);
+    gameData->round_outcome = OUTCOME_UNDECIDED;
+
+    CardList *lists[3] = { &gameData->deck, &gameData->player_hand, &gameData->dealer_hand };
+    offset = 4 + 1 + 8 + 4 + 4;
+
+    for (int list = 0; list < 3; list++)
+    {
+        uint8_t length = buf[offset++];
+
+        cardlist_free(lists[list]);
+        cardlist_init(lists[list]);
+
+        for (uint8_t i = 0; i < length; i++)
+        {
+            Card *current = malloc(sizeof(Card));
+            current->data = buf[offset++];
+            current->next = NULL;
+            cardlist_add(lists[list], current);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,26 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+    #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#define _GNU_SOURCE
+    #endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "game_structs.h"
+
+#define CHECKPOINT_VERSION (2)
+
+// ** CHECKPOINT FUNCTIONS **
+// writes the complete game state (rng, cards, cash, pot & outcome counts) to a file.
+// the file is first written under a temporary name and then renamed,
+// so a crash mid-write never leaves a half-written checkpoint behind.
+bool checkpoint_save(const GameData *gameData, const char *path);
+// restores game state from a checkpoint file, replacing the current cards.
+// returns false (leaving gameData untouched) if the file is missing or invalid.
+bool checkpoint_load(GameData *gameData, const char *path);
+
+#endif
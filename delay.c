@@ -1,8 +1,15 @@
 #include "delay.h"
 
+static bool delays_enabled = true;
+
+void delay_set_enabled(bool enabled)
+{
+    delays_enabled = enabled;
+}
+
 void delay_ms(uint32_t ms)
 {
-    if (ms <= 0) return;
+    if (ms <= 0 || !delays_enabled) return;
 
     #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
         uint32_t s = ms / 1000;
@@ -8,9 +8,12 @@
     #endif
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <time.h>
 
 // waits for specified number of milliseconds
 void delay_ms(uint32_t ms);
+// turns all delays on or off (off for load testing)
+void delay_set_enabled(bool enabled);
 
 #endif
@@ -0,0 +1,526 @@
+#include "exact_ev.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "util.h"
+
+// key layout: counts of classes 0-8 (3 bits each), ten-valued count (5 bits),
+// dealer upcard (4 bits) & which value is stored (1 bit)
+#define KEY_UPCARD_SHIFT (32)
+#define KEY_STAND_BIT ((uint64_t)1 << 36)
+// high bits of a table slot's key mark it as being written or ready
+#define SLOT_PENDING ((uint64_t)1 << 62)
+#define SLOT_READY ((uint64_t)1 << 63)
+
+typedef struct ExactSlot
+{
+    uint64_t key;
+    uint64_t value;
+} ExactSlot;
+
+typedef struct ExactJob
+{
+    ExactResult *result;
+    uint32_t *next;
+    uint32_t last;
+} ExactJob;
+
+static const char exact_file_magic[4] = { 'B', 'J', 'E', 'X' };
+static const uint8_t full_deck[EXACT_CLASSES] = { 4, 4, 4, 4, 4, 4, 4, 4, 4, 16 };
+
+// shared by all threads, see table_find & table_store
+static ExactSlot *table = NULL;
+static uint64_t table_entries = 0;
+
+// ace counts as 1, and is raised while the total stays below 22,
+// mirroring show_hand (an ace adds 9 while the total is under 13)
+static uint8_t hand_value(uint8_t hard, uint8_t aces)
+{
+    uint8_t total = hard;
+    while (total < 13 && aces > 0)
+    {
+        total += 9;
+        aces--;
+    }
+    return total;
+}
+
+static uint64_t make_key(const uint8_t counts[EXACT_CLASSES], uint8_t upcard)
+{
+    uint64_t key = 0;
+    for (int i = 0; i < EXACT_CLASSES - 1; i++)
+    {
+        key |= (uint64_t)counts[i] << (3 * i);
+    }
+    key |= (uint64_t)counts[EXACT_CLASSES - 1] << 27;
+    key |= (uint64_t)upcard << KEY_UPCARD_SHIFT;
+    return key;
+}
+
+static uint64_t hash_key(uint64_t key)
+{
+    key ^= key >> 31;
+    key *= 0x7FB5D329728EA185ull;
+    key ^= key >> 27;
+    return key;
+}
+
+static bool table_find(uint64_t key, double *value)
+{
+    size_t index = hash_key(key) & (EXACT_TABLE_SIZE - 1);
+
+    for (size_t probe = 0; probe < EXACT_TABLE_SIZE; probe++)
+    {
+        uint64_t slotKey = __atomic_load_n(&table[index].key, __ATOMIC_ACQUIRE);
+
+        if (slotKey == 0) return false;
+        if (slotKey == (key | SLOT_READY))
+        {
+            uint64_t bits = __atomic_load_n(&table[index].value, __ATOMIC_RELAXED);
+            memcpy(value, &bits, sizeof(bits));
+            return true;
+        }
+        // another thread is still computing it, which is fine to repeat
+        if (slotKey == (key | SLOT_PENDING)) return false;
+
+        index = (index + 1) & (EXACT_TABLE_SIZE - 1);
+    }
+
+    return false;
+}
+
+// values are deterministic, so when two threads race on a key
+// either result is the same and the loser simply doesn't store
+static void table_store(uint64_t key, double value)
+{
+    size_t index = hash_key(key) & (EXACT_TABLE_SIZE - 1);
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    for (size_t probe = 0; probe < EXACT_TABLE_SIZE; probe++)
+    {
+        uint64_t expected = 0;
+
+        if (__atomic_compare_exchange_n(&table[index].key, &expected, key | SLOT_PENDING,
+            false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            __atomic_store_n(&table[index].value, bits, __ATOMIC_RELAXED);
+            __atomic_store_n(&table[index].key, key | SLOT_READY, __ATOMIC_RELEASE);
+            __atomic_fetch_add(&table_entries, 1, __ATOMIC_RELAXED);
+            return;
+        }
+
+        if ((expected & ~(SLOT_PENDING | SLOT_READY)) == key) return;
+
+        index = (index + 1) & (EXACT_TABLE_SIZE - 1);
+    }
+}
+
+static double settle(uint8_t dealerValue, uint8_t playerValue)
+{
+    if (dealerValue > 21) return 1.0;
+    if (dealerValue > playerValue) return -1.0;
+    if (dealerValue == playerValue) return 0.0; // tie, the pot stays on the table
+    return 1.0;
+}
+
+// the dealer draws until 17 or over, or until ahead of the player
+static double dealer_play(uint8_t counts[EXACT_CLASSES], uint8_t remaining, uint8_t hard, uint8_t aces, uint8_t playerValue)
+{
+    uint8_t dealerValue = hand_value(hard, aces);
+    double ev = 0.0;
+
+    if (dealerValue >= 17 || dealerValue > playerValue || remaining == 0)
+    {
+        return settle(dealerValue, playerValue);
+    }
+
+    for (uint8_t card = 0; card < EXACT_CLASSES; card++)
+    {
+        if (counts[card] == 0) continue;
+
+        double probability = (double)counts[card] / remaining;
+        counts[card]--;
+        ev += probability * dealer_play(counts, remaining - 1, hard + card + 1, aces + (card == 0), playerValue);
+        counts[card]++;
+    }
+
+    return ev;
+}
+
+static double stand_ev(uint8_t counts[EXACT_CLASSES], uint8_t remaining, uint8_t upcard, uint8_t playerValue)
+{
+    uint64_t key = make_key(counts, upcard) | KEY_STAND_BIT;
+    double ev = 0.0;
+
+    if (table_find(key, &ev)) return ev;
+
+    // the hole card is unseen, so it is just as likely
+    // to be any card still in the deck once the player stands
+    for (uint8_t card = 0; card < EXACT_CLASSES; card++)
+    {
+        if (counts[card] == 0) continue;
+
+        double probability = (double)counts[card] / remaining;
+        counts[card]--;
+        ev += probability * dealer_play(counts, remaining - 1, upcard + card + 2,
+            (upcard == 0) + (card == 0), playerValue);
+        counts[card]++;
+    }
+
+    table_store(key, ev);
+
+    return ev;
+}
+
+// best EV of a player hand, which is whatever is missing from the deck
+// apart from the dealer's upcard (so the deck alone is the state)
+static double player_ev(uint8_t counts[EXACT_CLASSES], uint8_t remaining, uint8_t upcard, uint8_t hard, uint8_t aces)
+{
+    uint64_t key = make_key(counts, upcard);
+    uint8_t playerValue = hand_value(hard, aces);
+    double ev = 0.0;
+
+    if (table_find(key, &ev)) return ev;
+
+    double hit = 0.0;
+
+    for (uint8_t card = 0; card < EXACT_CLASSES; card++)
+    {
+        if (counts[card] == 0) continue;
+
+        double probability = (double)counts[card] / remaining;
+        uint8_t newHard = hard + card + 1;
+        uint8_t newAces = aces + (card == 0);
+        uint8_t newValue = hand_value(newHard, newAces);
+
+        if (newValue > 21)
+        {
+            hit -= probability;
+        }
+        else if (newValue == 21)
+        {
+            hit += probability * 1.5;
+        }
+        else
+        {
+            counts[card]--;
+            hit += probability * player_ev(counts, remaining - 1, upcard, newHard, newAces);
+            counts[card]++;
+        }
+    }
+
+    double stand = stand_ev(counts, remaining, upcard, playerValue);
+    ev = hit > stand ? hit : stand;
+
+    table_store(key, ev);
+
+    return ev;
+}
+
+static void solve_deal(ExactResult *result, uint32_t deal)
+{
+    uint8_t counts[EXACT_CLASSES];
+    uint8_t first = deal / (EXACT_CLASSES * EXACT_CLASSES);
+    uint8_t second = (deal / EXACT_CLASSES) % EXACT_CLASSES;
+    uint8_t upcard = deal % EXACT_CLASSES;
+    uint8_t remaining = 52;
+    double probability = 1.0;
+
+    memcpy(counts, full_deck, sizeof(counts));
+
+    const uint8_t cards[3] = { first, second, upcard };
+    for (int i = 0; i < 3; i++)
+    {
+        probability *= (double)counts[cards[i]] / remaining;
+        counts[cards[i]]--;
+        remaining--;
+    }
+
+    result->probability[deal] = probability;
+    result->ev[deal] = 0.0;
+    if (probability == 0.0) return;
+
+    uint8_t hard = first + second + 2;
+    uint8_t aces = (first == 0) + (second == 0);
+
+    // the game pays a blackjack straight away on a dealt 21
+    if (hand_value(hard, aces) == 21)
+    {
+        result->ev[deal] = 1.5;
+        return;
+    }
+
+    result->ev[deal] = player_ev(counts, remaining, upcard, hard, aces);
+}
+
+static void *exact_worker(void *arg)
+{
+    ExactJob *job = arg;
+
+    for (;;)
+    {
+        uint32_t deal = __atomic_fetch_add(job->next, 1, __ATOMIC_RELAXED);
+        if (deal >= job->last) break;
+        solve_deal(job->result, deal);
+    }
+
+    return NULL;
+}
+
+void exact_ev_solve(ExactResult *result, uint32_t first, uint32_t last, uint32_t threadCount)
+{
+    uint32_t next = first;
+    ExactJob job = { result, &next, last };
+
+    if (threadCount == 0) threadCount = 1;
+
+    table = calloc(EXACT_TABLE_SIZE, sizeof(ExactSlot));
+    table_entries = 0;
+
+    pthread_t *threads = calloc(threadCount, sizeof(pthread_t));
+
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        pthread_create(&threads[i], NULL, exact_worker, &job);
+    }
+
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(threads);
+    free(table);
+    table = NULL;
+}
+
+uint32_t exact_shard_first(uint32_t shardIndex, uint32_t shardCount)
+{
+    return (uint32_t)((uint64_t)EXACT_DEALS * shardIndex / shardCount);
+}
+
+double exact_ev_total(const ExactResult *result, uint32_t first, uint32_t last)
+{
+    double total = 0.0;
+
+    for (uint32_t deal = first; deal < last; deal++)
+    {
+        total += result->probability[deal] * result->ev[deal];
+    }
+
+    return total;
+}
+
+bool exact_ev_save(const ExactResult *result, const char *path, uint32_t shardIndex, uint32_t shardCount)
+{
+    uint32_t first = exact_shard_first(shardIndex, shardCount);
+    uint32_t last = exact_shard_first(shardIndex + 1, shardCount);
+    size_t size = 0;
+
+    uint8_t *buf = malloc(EXACT_FILE_HEADER_SIZE + (size_t)(last - first) * 2 * sizeof(double));
+    if (buf == NULL) return false;
+
+    memcpy(buf, exact_file_magic, sizeof(exact_file_magic));
+    size += sizeof(exact_file_magic);
+    size += put_uint(buf + size, EXACT_FILE_VERSION, 4);
+    size += put_uint(buf + size, EXACT_DEALS, 4);
+    size += put_uint(buf + size, shardIndex, 4);
+    size += put_uint(buf + size, shardCount, 4);
+    size += put_uint(buf + size, first, 4);
+    size += put_uint(buf + size, last, 4);
+    size += put_uint(buf + size, 0, 4);
+
+    for (uint32_t deal = first; deal < last; deal++)
+    {
+        size += put_double(buf + size, result->probability[deal]);
+        size += put_double(buf + size, result->ev[deal]);
+    }
+
+    bool ok = write_file_atomic(path, buf, size);
+    free(buf);
+
+    return ok;
+}
+
+bool exact_ev_load(ExactResult *result, bool covered[EXACT_DEALS], const char *path, uint32_t *shardCount)
+{
+    ExactFileHeader header;
+    uint8_t buf[EXACT_FILE_HEADER_SIZE];
+    uint8_t deal_buf[2 * sizeof(double)];
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return false;
+
+    bool ok = fread(buf, sizeof(buf), 1, file) == 1;
+    if (ok)
+    {
+        memcpy(header.magic, buf, sizeof(header.magic));
+        header.version = (uint32_t)get_uint(buf + 4, 4);
+        header.deals = (uint32_t)get_uint(buf + 8, 4);
+        header.shard_index = (uint32_t)get_uint(buf + 12, 4);
+        header.shard_count = (uint32_t)get_uint(buf + 16, 4);
+        header.first = (uint32_t)get_uint(buf + 20, 4);
+        header.last = (uint32_t)get_uint(buf + 24, 4);
+    }
+
+    ok = ok && memcmp(header.magic, exact_file_magic, sizeof(exact_file_magic)) == 0
+        && header.version == EXACT_FILE_VERSION
+        && header.deals == EXACT_DEALS
+        && header.first <= header.last && header.last <= EXACT_DEALS
+        && (*shardCount == 0 || header.shard_count == *shardCount);
+
+    // shards must not overlap, or their deals would count twice
+    for (uint32_t deal = header.first; ok && deal < header.last; deal++)
+    {
+        ok = !covered[deal] && fread(deal_buf, sizeof(deal_buf), 1, file) == 1;
+        if (!ok) break;
+
+        result->probability[deal] = get_double(deal_buf);
+        result->ev[deal] = get_double(deal_buf + sizeof(double));
+        covered[deal] = true;
+    }
+
+    fclose(file);
+
+    if (ok) *shardCount = header.shard_count;
+
+    return ok;
+}
+
+static void print_result(const ExactResult *result)
+{
+    double ev = exact_ev_total(result, 0, EXACT_DEALS);
+
+    printf("Single deck, optimal hit/stand, ties push.\n");
+    printf("Player EV per unit bet: %+.10f\n", ev);
+    printf("House edge: %.6f%%\n", -ev * 100.0);
+}
+
+int exact_ev_main(int argc, char *argv[])
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t threadCount = cores > 0 ? (uint32_t)cores : 1;
+    uint32_t shardIndex = 0;
+    uint32_t shardCount = 1;
+    const char *outPath = NULL;
+    struct timespec start, end;
+
+    for (int i = 0; i < argc; i++)
+    {
+        if (strcmp("--shard", argv[i]) == 0 && i + 1 < argc)
+        {
+            if (sscanf(argv[++i], "%u/%u", &shardIndex, &shardCount) != 2
+                || shardCount == 0 || shardCount > EXACT_DEALS || shardIndex >= shardCount)
+            {
+                printf("Invalid shard '%s', expected i/N with 0 <= i < N.\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp("-o", argv[i]) == 0 && i + 1 < argc) outPath = argv[++i];
+        else
+        {
+            // anything else must be the thread count, so typos aren't taken for one
+            char *end = NULL;
+            unsigned long value = strtoul(argv[i], &end, 10);
+
+            if (end == argv[i] || *end != '\0' || value == 0 || value > UINT32_MAX)
+            {
+                printf("Usage: prog exact [threads] [--shard i/N -o <result file>]\n");
+                return 1;
+            }
+            threadCount = (uint32_t)value;
+        }
+    }
+
+    if (shardCount > 1 && outPath == NULL)
+    {
+        printf("Usage: prog exact [threads] [--shard i/N -o <result file>]\n");
+        return 1;
+    }
+
+    uint32_t first = exact_shard_first(shardIndex, shardCount);
+    uint32_t last = exact_shard_first(shardIndex + 1, shardCount);
+
+    ExactResult *result = calloc(1, sizeof(ExactResult));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    exact_ev_solve(result, first, last, threadCount);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    if (shardCount == 1) print_result(result);
+    printf("Solved deals %u-%u (shard %u/%u) on %u threads in %.3fs, %llu positions cached.\n",
+        first, last, shardIndex, shardCount, threadCount, seconds, (unsigned long long)table_entries);
+
+    if (outPath != NULL && !exact_ev_save(result, outPath, shardIndex, shardCount))
+    {
+        fprintf(stderr, "Could not write result file '%s'.\n", outPath);
+        free(result);
+        return 1;
+    }
+
+    free(result);
+
+    return 0;
+}
+
+int exact_ev_merge_main(int argc, char *argv[])
+{
+    static bool covered[EXACT_DEALS];
+    uint32_t shardCount = 0;
+    const char *outPath = NULL;
+    int files = 0;
+
+    ExactResult *result = calloc(1, sizeof(ExactResult));
+
+    for (int i = 0; i < argc; i++)
+    {
+        if (strcmp("-o", argv[i]) == 0 && i + 1 < argc)
+        {
+            outPath = argv[++i];
+            continue;
+        }
+
+        if (!exact_ev_load(result, covered, argv[i], &shardCount))
+        {
+            fprintf(stderr, "Could not merge '%s' (unreadable, mismatched or overlapping shard).\n", argv[i]);
+            free(result);
+            return 1;
+        }
+        files++;
+    }
+
+    uint32_t missing = 0;
+    for (uint32_t deal = 0; deal < EXACT_DEALS; deal++)
+    {
+        missing += !covered[deal];
+    }
+
+    if (files == 0 || missing > 0)
+    {
+        if (files == 0) printf("Usage: prog merge <result file>... [-o <merged file>]\n");
+        else fprintf(stderr, "Shards are incomplete, %u of %u deals missing.\n", missing, EXACT_DEALS);
+        free(result);
+        return 1;
+    }
+
+    print_result(result);
+    printf("Merged %d result files of %u shards.\n", files, shardCount);
+
+    if (outPath != NULL && !exact_ev_save(result, outPath, 0, 1))
+    {
+        fprintf(stderr, "Could not write result file '%s'.\n", outPath);
+        free(result);
+        return 1;
+    }
+
+    free(result);
+
+    return 0;
+}
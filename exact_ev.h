@@ -0,0 +1,68 @@
+#ifndef EXACT_EV_H
+#define EXACT_EV_H
+
+    #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#define _GNU_SOURCE
+    #endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// card value classes: ace, 2-9 & ten-valued cards.
+// suits & the four ten-valued ranks never change the game,
+// so a deck is fully described by its count of each class.
+#define EXACT_CLASSES (10)
+// every initial deal: player card, player card, dealer upcard
+#define EXACT_DEALS (EXACT_CLASSES * EXACT_CLASSES * EXACT_CLASSES)
+// transposition table size, must be a power of two
+#define EXACT_TABLE_SIZE ((size_t)1 << 22)
+
+#define EXACT_FILE_VERSION (2)
+#define EXACT_FILE_HEADER_SIZE (4 + 7 * 4)
+
+// result file header, followed by (probability, ev) doubles
+// for every deal from first up to (not including) last.
+// every field is stored little-endian (doubles by their IEEE-754 bits),
+// so result files can move between machines.
+typedef struct ExactFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t deals; // EXACT_DEALS of the writer
+    uint32_t shard_index;
+    uint32_t shard_count;
+    uint32_t first;
+    uint32_t last;
+    uint32_t reserved;
+} ExactFileHeader;
+
+typedef struct ExactResult
+{
+    double probability[EXACT_DEALS];
+    double ev[EXACT_DEALS];
+} ExactResult;
+
+// ** EXACT EV FUNCTIONS **
+// solves the deals with first <= index < last (stepping by 1) across
+// threadCount threads, filling in their probability & player EV.
+// hit/stand decisions are played optimally; the dealer follows the game's rule.
+void exact_ev_solve(ExactResult *result, uint32_t first, uint32_t last, uint32_t threadCount);
+// first deal of a shard; shard i of N covers deals
+// exact_shard_first(i, N) up to exact_shard_first(i + 1, N)
+uint32_t exact_shard_first(uint32_t shardIndex, uint32_t shardCount);
+// player EV per unit bet over the given deals, summed in deal order,
+// so that merged shards add up bit for bit like a single run
+double exact_ev_total(const ExactResult *result, uint32_t first, uint32_t last);
+// writes a shard's deals to a result file, atomically replacing it
+bool exact_ev_save(const ExactResult *result, const char *path, uint32_t shardIndex, uint32_t shardCount);
+// reads a result file's deals into result, marking them in covered.
+// fails if any deal was already covered or if the shard count
+// differs from *shardCount (when non-zero), which it then sets.
+bool exact_ev_load(ExactResult *result, bool covered[EXACT_DEALS], const char *path, uint32_t *shardCount);
+// "exact" subcommand: prints the exact house edge of a fresh single deck,
+// or solves one shard of the deals into a result file
+int exact_ev_main(int argc, char *argv[]);
+// "merge" subcommand: combines shard result files into the full result
+int exact_ev_merge_main(int argc, char *argv[]);
+
+#endif
@@ -1,5 +1,23 @@
 #include "fancy_text.h"
 
+static uint64_t bytes_written = 0;
+
+// printf that keeps a running count of the bytes sent to stdout
+static void counted_printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int written = vprintf(format, args);
+    va_end(args);
+
+    if (written > 0) bytes_written += written;
+}
+
+uint64_t fancy_text_bytes_written(void)
+{
+    return bytes_written;
+}
+
 void flash_text(uint8_t reps, uint32_t delay, const char *text)
 {
     uint32_t third = delay/3;
@@ -11,11 +29,11 @@ void flash_text(uint8_t reps, uint32_t delay, const char *text)
 
     for (int i = 0; i < reps; i++)
     {
-        printf("\r%s", blank);
+        counted_printf("\r%s", blank);
         fflush(stdout);
         delay_ms(third);
 
-        printf("\r%s", text);
+        counted_printf("\r%s", text);
         fflush(stdout);
         delay_ms(third*2);
     }
@@ -27,7 +45,7 @@ void stagger_text_uniform(TextStagger_Uniform *pattern)
 {
     for (size_t i = 0; i < pattern->count; i++)
     {
-        printf("%s", pattern->chunks[i]);
+        counted_printf("%s", pattern->chunks[i]);
         fflush(stdout);
         delay_ms(pattern->delay);
     }
@@ -37,7 +55,7 @@ void stagger_text_uniform_repeat(size_t count, uint32_t delay, char* text)
 {
     for (size_t i = 0; i < count; i++)
     {
-        printf("%s", text);
+        counted_printf("%s", text);
         fflush(stdout);
         delay_ms(delay);
     }
@@ -47,7 +65,7 @@ void stagger_text_variable(size_t count, const TextStagger_VariableChunk pattern
 {
     for (size_t i = 0; i < count; i++)
     {
-        printf("%s", pattern[i].text);
+        counted_printf("%s", pattern[i].text);
         fflush(stdout);
         delay_ms(pattern[i].delay);
     }
@@ -57,7 +75,7 @@ void stagger_text_variable_repeat(size_t count, const uint16_t delay[], char* te
 {
     for (size_t i = 0; i < count; i++)
     {
-        printf("%s", text);
+        counted_printf("%s", text);
         fflush(stdout);
         delay_ms(delay[i]);
     }
@@ -67,7 +85,7 @@ void stagger_string(uint16_t delay, const char* text)
 {
     if (delay == 0)
     {
-        printf("%s", text);
+        counted_printf("%s", text);
         return;
     }
 
@@ -75,7 +93,7 @@ void stagger_string(uint16_t delay, const char* text)
 
     for (size_t i = 0; i < length; i++)
     {
-        printf("%c", text[i]);
+        counted_printf("%c", text[i]);
         fflush(stdout);
         delay_ms(delay);
     }
@@ -86,12 +104,12 @@ void run_up_number_2d(uint16_t delay, uint32_t number, uint32_t dramaNumber)
     float current = 0;
     float drama = 1.0;
 
-    printf("  ");
+    counted_printf("  ");
 
     while (current <= number)
     {
         drama = 1.1 - (fabsf(dramaNumber-current)/dramaNumber);
-        printf("\b\b%2u", (uint32_t)current);
+        counted_printf("\b\b%2u", (uint32_t)current);
         fflush(stdout);
         delay_ms(delay*drama);
         current++;
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <string.h>
 #include <math.h>
 #include "delay.h"
@@ -35,5 +36,7 @@ void stagger_text_variable_repeat(size_t count, const uint16_t delay[], char* te
 void stagger_string(uint16_t delay, const char* text);
 // textually increment up to a number from 0
 void run_up_number_2d(uint16_t delay, uint32_t number, uint32_t dramaNumber);
+// total bytes printed by the functions above, for measuring terminal traffic
+uint64_t fancy_text_bytes_written(void);
 
 #endif
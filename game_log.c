@@ -0,0 +1,104 @@
+#include "game_log.h"
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "card_funcs.h"
+
+static const char game_log_magic[4] = { 'B', 'J', 'L', 'G' };
+static int log_fd = -1;
+
+bool game_log_open(const char *path)
+{
+    struct stat info;
+
+    log_fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (log_fd < 0) return false;
+
+    if (fstat(log_fd, &info) != 0)
+    {
+        game_log_close();
+        return false;
+    }
+
+    // a new log starts with its header
+    if (info.st_size == 0)
+    {
+        GameLogHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, game_log_magic, sizeof(game_log_magic));
+        header.version = GAME_LOG_VERSION;
+        header.record_size = sizeof(GameLogRecord);
+
+        if (write(log_fd, &header, sizeof(header)) != sizeof(header))
+        {
+            game_log_close();
+            return false;
+        }
+    }
+    else
+    {
+        unsigned char header[GAME_LOG_HEADER_SIZE];
+
+        // only append to a log of this version, and never after a torn record,
+        // it would misalign the rest
+        if (info.st_size < GAME_LOG_HEADER_SIZE
+            || pread(log_fd, header, sizeof(header), 0) != sizeof(header)
+            || !game_log_check_header(header, sizeof(header))
+            || (info.st_size - GAME_LOG_HEADER_SIZE) % sizeof(GameLogRecord) != 0)
+        {
+            game_log_close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void game_log_round(const GameData *gameData, int32_t net)
+{
+    GameLogRecord records[MAX_DECISIONS];
+
+    if (log_fd < 0 || gameData->decision_count == 0 || gameData->dealer_hand.head == NULL) return;
+
+    uint8_t upcard = card_table[gameData->dealer_hand.head->data].value;
+
+    for (uint8_t i = 0; i < gameData->decision_count; i++)
+    {
+        memset(&records[i], 0, sizeof(GameLogRecord));
+        records[i].player_total = gameData->decisions[i].player_total;
+        records[i].soft = gameData->decisions[i].soft;
+        records[i].dealer_upcard = upcard;
+        records[i].action = gameData->decisions[i].action;
+        records[i].outcome = (int8_t)gameData->round_outcome;
+        records[i].dealer_total = gameData->dealer_total;
+        records[i].stake = gameData->pot;
+        records[i].net = net;
+    }
+
+    // one append per round keeps its records together
+    size_t size = sizeof(GameLogRecord) * gameData->decision_count;
+    if (write(log_fd, records, size) != (ssize_t)size)
+    {
+        game_log_close();
+    }
+}
+
+void game_log_close(void)
+{
+    if (log_fd >= 0) close(log_fd);
+    log_fd = -1;
+}
+
+bool game_log_check_header(const void *data, size_t size)
+{
+    GameLogHeader header;
+
+    if (size < GAME_LOG_HEADER_SIZE) return false;
+    memcpy(&header, data, sizeof(header));
+
+    return memcmp(header.magic, game_log_magic, sizeof(game_log_magic)) == 0
+        && header.version == GAME_LOG_VERSION
+        && header.record_size == sizeof(GameLogRecord);
+}
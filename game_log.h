@@ -0,0 +1,50 @@
+#ifndef GAME_LOG_H
+#define GAME_LOG_H
+
+    #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#define _GNU_SOURCE
+    #endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_structs.h"
+
+#define GAME_LOG_VERSION (1)
+#define GAME_LOG_HEADER_SIZE (16)
+
+// one record per player decision, written when its round is settled.
+// records are fixed-size so that any record-aligned slice of a log
+// can be parsed on its own.
+typedef struct GameLogRecord
+{
+    uint8_t player_total;
+    uint8_t soft;
+    uint8_t dealer_upcard; // 1 (ace) to 10
+    uint8_t action; // DecisionAction
+    int8_t outcome; // RoundOutcome
+    uint8_t dealer_total; // dealer's final total, 0 if the dealer didn't play
+    uint8_t reserved[2];
+    uint32_t stake; // pot played for in the round, a tie pushes it to the next
+    int32_t net; // player's net win (or loss) of that pot
+} GameLogRecord;
+
+// file header, followed by records until the end of the file
+typedef struct GameLogHeader
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t record_size;
+    uint8_t reserved[8];
+} GameLogHeader;
+
+// ** GAME LOG FUNCTIONS **
+// opens (or creates) a log file for appending
+bool game_log_open(const char *path);
+// appends the decisions of a settled round
+void game_log_round(const GameData *gameData, int32_t net);
+// closes the log file
+void game_log_close(void);
+// checks that a buffer starts with a valid game log header
+bool game_log_check_header(const void *data, size_t size);
+
+#endif
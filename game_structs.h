@@ -0,0 +1,51 @@
+#ifndef GAME_STRUCTS_H
+#define GAME_STRUCTS_H
+
+#include <stdint.h>
+#include "card_structs.h"
+
+typedef enum RoundOutcome
+{
+    OUTCOME_BROKE = -2,
+    OUTCOME_QUIT = -1,
+    OUTCOME_UNDECIDED = 0,
+    OUTCOME_BLACKJACK = 1, // player wins pot * 2.5
+    OUTCOME_WIN = 2, // player wins pot * 2
+    OUTCOME_LOSE = 3, // no win, pot reset to zero
+    OUTCOME_TIE = 4 // no win, pot not reset
+} RoundOutcome;
+
+// most hit/stand decisions possible in one round,
+// drawing the smallest cards first: 4 aces, 4 twos & a three
+#define MAX_DECISIONS (12)
+
+typedef enum DecisionAction
+{
+    ACTION_HIT = 0,
+    ACTION_STAND = 1
+} DecisionAction;
+
+// player hand as it was when a decision was made
+typedef struct RoundDecision
+{
+    uint8_t player_total;
+    uint8_t soft;
+    uint8_t action;
+} RoundDecision;
+
+typedef struct GameData
+{
+    RoundOutcome round_outcome;
+    uint32_t cash;
+    uint32_t pot;
+    uint64_t rng_state;
+    CardList deck;
+    CardList player_hand;
+    CardList dealer_hand;
+    uint8_t decision_count;
+    RoundDecision decisions[MAX_DECISIONS];
+    uint8_t dealer_total; // dealer's final total, 0 if the dealer didn't play
+    struct OutcomeTable *outcomes; // per-state outcome counts, NULL if off
+} GameData;
+
+#endif
@@ -0,0 +1,280 @@
+#include "ledger.h"
+
+#include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "util.h"
+
+// locks, always taken in this order:
+// flock on sync_fd - the leader doing an fdatasync for everyone
+// flock on ledger_fd - appending or measuring the ledger, held only briefly
+// fcntl byte lock at offset account on ledger_fd - the account's owner, for as long as it's open.
+// byte locks belong to the process & go with any close of the file, so it's opened only once.
+static int ledger_fd = -1;
+static int sync_fd = -1;
+static LedgerSyncState *sync_state = NULL;
+static uint32_t account_id = 0;
+static uint64_t next_sequence = 1;
+static bool failed = false;
+
+// statistics
+static uint64_t stat_records = 0;
+static uint64_t stat_shared = 0; // made durable by another process' fdatasync
+static uint64_t stat_syncs = 0;
+static uint64_t stat_synced_records = 0; // by our own fdatasyncs, any account's
+static uint64_t stat_sync_total_us = 0;
+static uint64_t stat_sync_max_us = 0;
+static uint64_t stat_latency_total_us = 0;
+static uint64_t stat_latency_max_us = 0;
+
+static uint32_t record_checksum(const LedgerRecord *record)
+{
+    return fnv1a(record, offsetof(LedgerRecord, checksum));
+}
+
+static bool lock_account(uint32_t account)
+{
+    struct flock range;
+
+    memset(&range, 0, sizeof(range));
+    range.l_type = F_WRLCK;
+    range.l_whence = SEEK_SET;
+    range.l_start = (off_t)account;
+    range.l_len = 1;
+
+    return fcntl(ledger_fd, F_SETLK, &range) == 0;
+}
+
+static bool map_sync_state(void)
+{
+    struct stat info;
+
+    // every process may race to size a new file, which is harmless
+    if (fstat(sync_fd, &info) != 0 || (info.st_size < (off_t)sizeof(LedgerSyncState)
+        && ftruncate(sync_fd, sizeof(LedgerSyncState)) != 0)) return false;
+
+    void *state = mmap(NULL, sizeof(LedgerSyncState), PROT_READ | PROT_WRITE, MAP_SHARED, sync_fd, 0);
+    if (state == MAP_FAILED) return false;
+
+    sync_state = state;
+
+    return true;
+}
+
+// length of the ledger, which only ever holds whole records between appends
+static off_t ledger_length(void)
+{
+    if (flock(ledger_fd, LOCK_EX) != 0) return -1;
+    off_t length = lseek(ledger_fd, 0, SEEK_END);
+    flock(ledger_fd, LOCK_UN);
+
+    return length;
+}
+
+// returns the end of the appended record, or -1
+static off_t append_record(const LedgerRecord *record)
+{
+    off_t end = -1;
+
+    if (flock(ledger_fd, LOCK_EX) != 0) return -1;
+
+    off_t start = lseek(ledger_fd, 0, SEEK_END);
+    ssize_t written = start < 0 ? -1 : write(ledger_fd, record, sizeof(LedgerRecord));
+
+    if (written == sizeof(LedgerRecord)) end = start + (off_t)sizeof(LedgerRecord);
+    // cut a partly written record off while nothing can be appended after it
+    else if (written > 0 && ftruncate(ledger_fd, start) != 0) failed = true;
+
+    flock(ledger_fd, LOCK_UN);
+
+    return end;
+}
+
+// makes the ledger durable up to end.
+// the first process to take the sync lock leads: one fdatasync covers every record
+// any process has appended by then, and those queued behind it find theirs done.
+static bool sync_to(off_t end)
+{
+    if (__atomic_load_n(&sync_state->synced_length, __ATOMIC_ACQUIRE) >= (uint64_t)end)
+    {
+        stat_shared++;
+        return true;
+    }
+
+    if (flock(sync_fd, LOCK_EX) != 0) return false;
+
+    uint64_t synced = __atomic_load_n(&sync_state->synced_length, __ATOMIC_ACQUIRE);
+    bool ok = true;
+
+    if (synced >= (uint64_t)end) stat_shared++;
+    else
+    {
+        off_t target = ledger_length();
+        uint64_t syncStart = now_us();
+        ok = target >= end && fdatasync(ledger_fd) == 0;
+        uint64_t syncTime = now_us() - syncStart;
+
+        // a failed fdatasync proves nothing, the processes behind it try their own
+        if (ok)
+        {
+            __atomic_store_n(&sync_state->synced_length, (uint64_t)target, __ATOMIC_RELEASE);
+            stat_syncs++;
+            stat_synced_records += ((uint64_t)target - synced) / sizeof(LedgerRecord);
+            stat_sync_total_us += syncTime;
+            if (syncTime > stat_sync_max_us) stat_sync_max_us = syncTime;
+        }
+    }
+
+    flock(sync_fd, LOCK_UN);
+
+    return ok;
+}
+
+bool ledger_open(const char *path, uint32_t account, uint32_t *cash, uint32_t *pot, bool *recovered, bool *unsettled)
+{
+    char syncPath[256];
+    LedgerRecord record;
+    off_t validLength = 0;
+    uint64_t lastSequence = 0;
+    bool ok = true;
+
+    *recovered = false;
+    *unsettled = false;
+
+    if (snprintf(syncPath, sizeof(syncPath), "%s.sync", path) >= (int)sizeof(syncPath)) return false;
+
+    ledger_fd = open(path, O_RDWR | O_CREAT, 0644);
+    sync_fd = open(syncPath, O_RDWR | O_CREAT, 0644);
+
+    // one game per account: a second one would replay the same records
+    // and continue its sequence alongside the first one
+    if (ledger_fd < 0 || sync_fd < 0 || !lock_account(account) || !map_sync_state()
+        || flock(sync_fd, LOCK_EX) != 0)
+    {
+        ledger_close();
+        return false;
+    }
+
+    if (flock(ledger_fd, LOCK_EX) != 0)
+    {
+        flock(sync_fd, LOCK_UN);
+        ledger_close();
+        return false;
+    }
+
+    // replay: the balances of the account's last intact record are the current ones
+    while (pread(ledger_fd, &record, sizeof(record), validLength) == sizeof(record)
+        && record.checksum == record_checksum(&record))
+    {
+        validLength += sizeof(record);
+        if (record.account != account) continue;
+
+        // a gap can't come from a crash, the account's history is broken
+        if (record.sequence != lastSequence + 1)
+        {
+            ok = false;
+            break;
+        }
+
+        *cash = record.cash;
+        *pot = record.pot;
+        *recovered = true;
+        *unsettled = record.type == LEDGER_BET;
+        lastSequence = record.sequence;
+    }
+
+    // drop a torn or corrupt tail, so new records follow the last good one.
+    // appends hold the ledger lock, so it's never another game's record in progress.
+    if (ok && lseek(ledger_fd, 0, SEEK_END) > validLength) ok = ftruncate(ledger_fd, validLength) == 0;
+
+    // a sync state left from before a crash may count bytes that were just cut off
+    if (ok && __atomic_load_n(&sync_state->synced_length, __ATOMIC_ACQUIRE) > (uint64_t)validLength)
+    {
+        __atomic_store_n(&sync_state->synced_length, (uint64_t)validLength, __ATOMIC_RELEASE);
+    }
+
+    flock(ledger_fd, LOCK_UN);
+    flock(sync_fd, LOCK_UN);
+
+    if (!ok)
+    {
+        ledger_close();
+        return false;
+    }
+
+    account_id = account;
+    next_sequence = lastSequence + 1;
+    failed = false;
+
+    return true;
+}
+
+bool ledger_commit(LedgerType type, RoundOutcome outcome, uint32_t amount, uint32_t cash, uint32_t pot)
+{
+    LedgerRecord record;
+
+    if (ledger_fd < 0) return true;
+    if (failed) return false;
+
+    memset(&record, 0, sizeof(record));
+    record.sequence = next_sequence;
+    record.type = type;
+    record.outcome = (int8_t)outcome;
+    record.account = account_id;
+    record.amount = amount;
+    record.cash = cash;
+    record.pot = pot;
+    record.checksum = record_checksum(&record);
+
+    uint64_t start = now_us();
+    off_t end = append_record(&record);
+
+    if (end < 0 || !sync_to(end))
+    {
+        failed = true;
+        return false;
+    }
+
+    uint64_t latency = now_us() - start;
+
+    next_sequence++;
+    stat_records++;
+    stat_latency_total_us += latency;
+    if (latency > stat_latency_max_us) stat_latency_max_us = latency;
+
+    return true;
+}
+
+void ledger_report(FILE *out)
+{
+    if (stat_records == 0) return;
+
+    fprintf(out, "Ledger: %llu records, %llu made durable by another game's fdatasync.\n",
+        (unsigned long long)stat_records, (unsigned long long)stat_shared);
+    if (stat_syncs > 0)
+    {
+        fprintf(out, "fdatasync: %llu, %.2f records each, avg %.3fms, max %.3fms.\n",
+            (unsigned long long)stat_syncs, (double)stat_synced_records / stat_syncs,
+            stat_sync_total_us / 1000.0 / stat_syncs, stat_sync_max_us / 1000.0);
+    }
+    fprintf(out, "Commit latency: avg %.3fms, max %.3fms.\n",
+        stat_latency_total_us / 1000.0 / stat_records, stat_latency_max_us / 1000.0);
+    fprintf(out, "Throughput: %.0f records/s of commit time.\n",
+        stat_latency_total_us ? stat_records * 1e6 / stat_latency_total_us : 0.0);
+}
+
+void ledger_close(void)
+{
+    if (sync_state != NULL) munmap(sync_state, sizeof(LedgerSyncState));
+    // closing drops the locks
+    if (sync_fd >= 0) close(sync_fd);
+    if (ledger_fd >= 0) close(ledger_fd);
+
+    sync_state = NULL;
+    sync_fd = -1;
+    ledger_fd = -1;
+}
@@ -0,0 +1,61 @@
+#ifndef LEDGER_H
+#define LEDGER_H
+
+    #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#define _GNU_SOURCE
+    #endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_structs.h"
+
+typedef enum LedgerType
+{
+    LEDGER_OPEN = 1, // starting balance of a new account
+    LEDGER_BET = 2, // cash moved into the pot
+    LEDGER_SETTLE = 3 // round settled, amount is the payout
+} LedgerType;
+
+// fixed-size record, balances are the state of its account after the entry.
+// every game sharing a ledger appends its own account's records to it,
+// replaying the log stops at the first record that is torn
+// or fails its checksum, which is where a crash cut it off.
+typedef struct LedgerRecord
+{
+    uint64_t sequence; // counts up from 1 within the account
+    uint8_t type; // LedgerType
+    int8_t outcome; // RoundOutcome, for LEDGER_SETTLE
+    uint16_t reserved;
+    uint32_t account;
+    uint32_t amount;
+    uint32_t cash;
+    uint32_t pot;
+    uint32_t checksum; // FNV-1a of all the bytes before it
+} LedgerRecord;
+
+// mapped from "<ledger>.sync" by every process using the ledger
+typedef struct LedgerSyncState
+{
+    uint64_t synced_length; // ledger bytes some process has fdatasync'd
+} LedgerSyncState;
+
+// ** LEDGER FUNCTIONS **
+// opens (or creates) a ledger shared by any number of games & replays one account.
+// returns true with the account's last recorded balances in cash & pot and
+// recovered set if it has any records, and unsettled set
+// if its last one is a bet whose round was cut off before it settled.
+// the account stays locked to this process until ledger_close,
+// so opening one already played by another game fails.
+bool ledger_open(const char *path, uint32_t account, uint32_t *cash, uint32_t *pot, bool *recovered, bool *unsettled);
+// appends a record & returns once it is durable, or false if it never will be,
+// after which nothing more is written. always succeeds when no ledger is open.
+// concurrent games share their fdatasyncs: whoever syncs first covers
+// every record appended so far, the others find theirs already done.
+bool ledger_commit(LedgerType type, RoundOutcome outcome, uint32_t amount, uint32_t cash, uint32_t pot);
+// prints commit latency & throughput, and how many commits shared an fdatasync
+void ledger_report(FILE *out);
+// closes the ledger, releasing the account
+void ledger_close(void);
+
+#endif
@@ -0,0 +1,464 @@
+#include "loadgen.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "rng.h"
+#include "util.h"
+
+typedef struct LoadgenPrompt
+{
+    const char *text;
+    LoadgenAction answers;
+} LoadgenPrompt;
+
+typedef enum LoadgenPromptId
+{
+    PROMPT_ENTER = 0,
+    PROMPT_PLAY = 1,
+    PROMPT_BET = 2,
+    PROMPT_BET_INVALID = 3,
+    PROMPT_HIT_OR_STAND = 4,
+    PROMPT_COUNT = 5
+} LoadgenPromptId;
+
+static const char *prompt_texts[PROMPT_COUNT] =
+{
+    "Press 'Enter' to continue.",
+    "Play a round? (Y/N)",
+    "10 X $",
+    "must be greater than zero.",
+    "or \"stand\" to answer)"
+};
+
+static const char *action_names[LOADGEN_ACTION_COUNT] =
+{
+    "continue", "play", "bet", "hit", "stand"
+};
+
+static uint32_t histogram_index(uint64_t value)
+{
+    if (value < HISTOGRAM_SUB_BUCKETS) return (uint32_t)value;
+
+    uint32_t exponent = 63 - __builtin_clzll(value) - HISTOGRAM_SUB_BITS;
+    return HISTOGRAM_SUB_BUCKETS + exponent * HISTOGRAM_SUB_BUCKETS
+        + (uint32_t)(value >> exponent) - HISTOGRAM_SUB_BUCKETS;
+}
+
+static uint64_t histogram_upper_bound(uint32_t index)
+{
+    if (index < HISTOGRAM_SUB_BUCKETS) return index;
+
+    uint32_t exponent = (index - HISTOGRAM_SUB_BUCKETS) / HISTOGRAM_SUB_BUCKETS;
+    uint64_t sub = (index - HISTOGRAM_SUB_BUCKETS) % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS;
+    return ((sub + 1) << exponent) - 1;
+}
+
+void histogram_add(Histogram *histogram, uint64_t value)
+{
+    histogram->counts[histogram_index(value)]++;
+    histogram->total++;
+    if (value > histogram->max) histogram->max = value;
+}
+
+uint64_t histogram_percentile(const Histogram *histogram, double fraction)
+{
+    uint64_t target = (uint64_t)(fraction * histogram->total + 0.5);
+    uint64_t seen = 0;
+
+    if (target == 0) target = 1;
+
+    for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        seen += histogram->counts[i];
+        if (seen >= target)
+        {
+            uint64_t bound = histogram_upper_bound(i);
+            return bound < histogram->max ? bound : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
+
+static bool spawn_session(LoadgenSession *session, const char *exe, uint64_t seed, bool animations,
+    const char *ledgerPath, uint32_t account)
+{
+    struct winsize size = { 50, 100, 0, 0 };
+    char seedText[24];
+    char accountText[16];
+    const char *args[8];
+    int argCount = 0;
+
+    snprintf(seedText, sizeof(seedText), "%llu", (unsigned long long)seed);
+    snprintf(accountText, sizeof(accountText), "%u", account);
+
+    args[argCount++] = exe;
+    if (!animations) args[argCount++] = "--fast";
+    // the ledger refuses a known seed, so its games are dealt at random
+    if (ledgerPath != NULL)
+    {
+        args[argCount++] = "--ledger";
+        args[argCount++] = ledgerPath;
+        args[argCount++] = "--account";
+        args[argCount++] = accountText;
+    }
+    else
+    {
+        args[argCount++] = "--seed";
+        args[argCount++] = seedText;
+    }
+    args[argCount] = NULL;
+
+    memset(session, 0, sizeof(LoadgenSession));
+    session->reply_action = LOADGEN_NONE;
+    session->pending_action = LOADGEN_NONE;
+
+    session->pid = forkpty(&session->fd, NULL, NULL, &size);
+    if (session->pid < 0) return false;
+
+    if (session->pid == 0)
+    {
+        execv(exe, (char *const *)args);
+        _exit(127);
+    }
+
+    fcntl(session->fd, F_SETFL, fcntl(session->fd, F_GETFL) | O_NONBLOCK);
+
+    return true;
+}
+
+// closes a session's pty & reaps its game, killing it first if it's stuck
+static void finish_session(LoadgenSession *session, bool failed)
+{
+    if (failed) kill(session->pid, SIGKILL);
+    close(session->fd);
+    waitpid(session->pid, NULL, 0);
+    session->done = true;
+    session->failed = failed;
+}
+
+// writes as much of the pending reply as the pty takes,
+// returns false if the session is lost
+static bool send_reply(LoadgenSession *session)
+{
+    size_t length = strlen(session->reply);
+    ssize_t written = write(session->fd, session->reply + session->reply_sent, length - session->reply_sent);
+
+    if (written < 0) return errno == EAGAIN || errno == EINTR;
+
+    session->reply_sent += (size_t)written;
+
+    // timed from the moment the whole reply is in
+    if (session->reply_sent == length)
+    {
+        session->pending_action = session->reply_action;
+        session->sent_at = now_us();
+        session->reply = NULL;
+        session->reply_sent = 0;
+    }
+
+    return true;
+}
+
+// picks the scripted answer to a prompt
+static void answer_prompt(LoadgenSession *session, LoadgenPromptId prompt, uint32_t rounds, uint32_t hitsPerRound)
+{
+    switch (prompt)
+    {
+        case PROMPT_ENTER:
+            session->reply = "\n";
+            session->reply_action = LOADGEN_CONTINUE;
+            break;
+        case PROMPT_PLAY:
+            if (session->rounds < rounds)
+            {
+                session->reply = "y\n";
+                session->reply_action = LOADGEN_PLAY;
+            }
+            else
+            {
+                // quitting isn't timed, the session just ends
+                session->reply = "n\n";
+                session->reply_action = LOADGEN_NONE;
+            }
+            break;
+        case PROMPT_BET:
+            session->reply = "1\n";
+            session->reply_action = LOADGEN_BET;
+            session->rounds++;
+            session->hits = 0;
+            break;
+        case PROMPT_BET_INVALID:
+            // less than $10 left but a tied pot on the table
+            session->reply = "0\n";
+            session->reply_action = LOADGEN_BET;
+            break;
+        case PROMPT_HIT_OR_STAND:
+        default:
+            if (session->hits < hitsPerRound)
+            {
+                session->reply = "hit\n";
+                session->reply_action = LOADGEN_HIT;
+                session->hits++;
+            }
+            else
+            {
+                session->reply = "stand\n";
+                session->reply_action = LOADGEN_STAND;
+            }
+            break;
+    }
+}
+
+// looks for a prompt in the newest output, joined to the tail of the previous read
+static int find_prompt(LoadgenSession *session, const char *data, size_t length)
+{
+    char buffer[LOADGEN_TAIL_SIZE + 4096];
+    size_t total = 0;
+    int found = -1;
+
+    memcpy(buffer, session->tail, session->tail_length);
+    total = session->tail_length;
+    memcpy(buffer + total, data, length);
+    total += length;
+
+    for (int prompt = 0; prompt < PROMPT_COUNT && found < 0; prompt++)
+    {
+        if (memmem(buffer, total, prompt_texts[prompt], strlen(prompt_texts[prompt])) != NULL) found = prompt;
+    }
+
+    // a prompt is answered once, so forget the output that held it
+    if (found >= 0) total = 0;
+
+    session->tail_length = total < LOADGEN_TAIL_SIZE ? total : LOADGEN_TAIL_SIZE;
+    memcpy(session->tail, buffer + total - session->tail_length, session->tail_length);
+
+    return found;
+}
+
+static void print_histogram(const char *name, const Histogram *histogram)
+{
+    if (histogram->total == 0) return;
+
+    printf("%-9s %10llu %10.3f %10.3f %10.3f %10.3f\n", name, (unsigned long long)histogram->total,
+        histogram_percentile(histogram, 0.50) / 1000.0,
+        histogram_percentile(histogram, 0.99) / 1000.0,
+        histogram_percentile(histogram, 0.999) / 1000.0,
+        histogram->max / 1000.0);
+}
+
+int loadgen_main(int argc, char *argv[])
+{
+    uint32_t sessionCount = 100;
+    uint32_t thinkMs = 100;
+    uint32_t rounds = 10;
+    uint32_t hitsPerRound = 1;
+    uint32_t timeoutSeconds = LOADGEN_DEFAULT_TIMEOUT;
+    bool animations = false;
+    const char *ledgerPath = NULL;
+    uint64_t seed = 1;
+    char exe[4096];
+    struct rlimit limit;
+    struct rusage usage;
+
+    for (int i = 0; i < argc; i++)
+    {
+        if (strcmp("-n", argv[i]) == 0 && i + 1 < argc) sessionCount = strtoul(argv[++i], NULL, 10);
+        else if (strcmp("-t", argv[i]) == 0 && i + 1 < argc) thinkMs = strtoul(argv[++i], NULL, 10);
+        else if (strcmp("-r", argv[i]) == 0 && i + 1 < argc) rounds = strtoul(argv[++i], NULL, 10);
+        else if (strcmp("-h", argv[i]) == 0 && i + 1 < argc) hitsPerRound = strtoul(argv[++i], NULL, 10);
+        else if (strcmp("-s", argv[i]) == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp("-T", argv[i]) == 0 && i + 1 < argc) timeoutSeconds = strtoul(argv[++i], NULL, 10);
+        else if (strcmp("-a", argv[i]) == 0) animations = true;
+        else if (strcmp("-l", argv[i]) == 0 && i + 1 < argc) ledgerPath = argv[++i];
+        else
+        {
+            printf("Usage: prog loadgen [-n sessions] [-t think ms] [-r rounds] [-h hits per round] [-s seed] [-T timeout s] [-a] [-l ledger]\n");
+            printf("  -a keeps the game's animations & delays on\n");
+            printf("  -l plays every session on its own account of one shared ledger\n");
+            printf("  -T kills a session that shows no prompt for that long (default %u)\n", LOADGEN_DEFAULT_TIMEOUT);
+            return 1;
+        }
+    }
+
+    ssize_t exeLength = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (exeLength <= 0)
+    {
+        fprintf(stderr, "Could not find own executable.\n");
+        return 1;
+    }
+    exe[exeLength] = '\0';
+
+    // one pty master per session
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    LoadgenSession *sessions = calloc(sessionCount, sizeof(LoadgenSession));
+    struct pollfd *fds = calloc(sessionCount, sizeof(struct pollfd));
+    uint32_t *fdSessions = calloc(sessionCount, sizeof(uint32_t));
+    Histogram *histograms = calloc(LOADGEN_ACTION_COUNT + 1, sizeof(Histogram));
+    Histogram *overall = &histograms[LOADGEN_ACTION_COUNT];
+    uint64_t thinkRng;
+    uint32_t running = 0;
+    uint32_t failedCount = 0;
+    const uint64_t stuckAfter = (uint64_t)timeoutSeconds * 1000000;
+
+    rng_seed(&thinkRng, seed);
+
+    uint64_t start = now_us();
+
+    for (uint32_t i = 0; i < sessionCount; i++)
+    {
+        if (!spawn_session(&sessions[i], exe, seed + i, animations, ledgerPath, i))
+        {
+            fprintf(stderr, "Could only start %u sessions.\n", i);
+            sessionCount = i;
+            break;
+        }
+        sessions[i].deadline = now_us() + stuckAfter;
+        running++;
+    }
+
+    while (running > 0)
+    {
+        uint64_t now = now_us();
+        uint64_t nextReply = now + 100000;
+        nfds_t fdCount = 0;
+
+        // send replies whose think time has passed
+        for (uint32_t i = 0; i < sessionCount; i++)
+        {
+            LoadgenSession *session = &sessions[i];
+            if (session->done) continue;
+
+            // waiting on its own think time doesn't count against a session
+            if (session->reply == NULL && session->deadline <= now)
+            {
+                finish_session(session, true);
+                failedCount++;
+                running--;
+                continue;
+            }
+
+            if (session->reply != NULL)
+            {
+                if (session->reply_at <= now && !send_reply(session))
+                {
+                    finish_session(session, true);
+                    failedCount++;
+                    running--;
+                    continue;
+                }
+                else if (session->reply != NULL && session->reply_at > now && session->reply_at < nextReply)
+                {
+                    nextReply = session->reply_at;
+                }
+            }
+
+            if (session->reply == NULL && session->deadline < nextReply)
+            {
+                nextReply = session->deadline;
+            }
+
+            fds[fdCount].fd = session->fd;
+            // a reply the pty didn't fully take goes out once it has room
+            fds[fdCount].events = POLLIN;
+            if (session->reply != NULL && session->reply_at <= now) fds[fdCount].events |= POLLOUT;
+            fdSessions[fdCount] = i;
+            fdCount++;
+        }
+
+        if (fdCount == 0) break;
+
+        int timeout = (int)((nextReply - now + 999) / 1000);
+        if (poll(fds, fdCount, timeout) < 0 && errno != EINTR) break;
+
+        for (nfds_t f = 0; f < fdCount; f++)
+        {
+            if ((fds[f].revents & ~POLLOUT) == 0) continue;
+
+            LoadgenSession *session = &sessions[fdSessions[f]];
+            char data[4096];
+            ssize_t length = read(session->fd, data, sizeof(data));
+
+            if (length < 0 && errno == EAGAIN) continue;
+
+            // EOF (or EIO once the game exits & closes its side)
+            if (length <= 0)
+            {
+                finish_session(session, false);
+                running--;
+                continue;
+            }
+
+            int prompt = find_prompt(session, data, (size_t)length);
+            if (prompt < 0) continue;
+
+            uint64_t seen = now_us();
+
+            if (session->pending_action != LOADGEN_NONE)
+            {
+                histogram_add(&histograms[session->pending_action], seen - session->sent_at);
+                histogram_add(overall, seen - session->sent_at);
+                session->pending_action = LOADGEN_NONE;
+            }
+
+            // think time varies +-50% around the configured value
+            uint64_t think = (uint64_t)thinkMs * 1000;
+            if (think > 0) think = think / 2 + rng_range(&thinkRng, (uint32_t)think);
+
+            answer_prompt(session, (LoadgenPromptId)prompt, rounds, hitsPerRound);
+            session->reply_at = seen + think;
+            session->deadline = session->reply_at + stuckAfter;
+        }
+    }
+
+    double seconds = (now_us() - start) / 1e6;
+    getrusage(RUSAGE_CHILDREN, &usage);
+    double cpuSeconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+        + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    double coresUsed = cpuSeconds / seconds;
+    uint64_t roundsPlayed = 0;
+
+    for (uint32_t i = 0; i < sessionCount; i++)
+    {
+        roundsPlayed += sessions[i].rounds;
+    }
+
+    printf("%u sessions, %llu rounds in %.2fs (%.1f rounds/s), think time %ums.\n",
+        sessionCount, (unsigned long long)roundsPlayed, seconds, roundsPlayed / seconds, thinkMs);
+    if (failedCount > 0)
+    {
+        printf("%u sessions got stuck or lost their terminal and were killed after %us.\n",
+            failedCount, timeoutSeconds);
+    }
+    printf("Games used %.2fs of CPU, %.3f cores on average: %.0f sessions per core.\n",
+        cpuSeconds, coresUsed, coresUsed > 0 ? sessionCount / coresUsed : 0.0);
+    printf("\n%-9s %10s %10s %10s %10s %10s\n", "action", "count", "p50 ms", "p99 ms", "p999 ms", "max ms");
+
+    for (int action = 0; action < LOADGEN_ACTION_COUNT; action++)
+    {
+        print_histogram(action_names[action], &histograms[action]);
+    }
+    print_histogram("all", overall);
+
+    free(histograms);
+    free(fdSessions);
+    free(fds);
+    free(sessions);
+
+    return 0;
+}
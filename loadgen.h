@@ -0,0 +1,72 @@
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+    #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#define _GNU_SOURCE
+    #endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+// HDR-style histogram: each power of two of microseconds
+// is split into linear sub-buckets, for ~3% precision at any scale
+#define HISTOGRAM_SUB_BITS (5)
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_BUCKETS (64 * HISTOGRAM_SUB_BUCKETS)
+// output kept between reads, so prompts split across reads are still found
+#define LOADGEN_TAIL_SIZE (64)
+// seconds a session may go without showing a prompt before it's counted as stuck
+#define LOADGEN_DEFAULT_TIMEOUT (30)
+
+typedef enum LoadgenAction
+{
+    LOADGEN_CONTINUE = 0, // 'Enter' at a "Press 'Enter'" prompt
+    LOADGEN_PLAY = 1, // 'y' at the "Play a round?" prompt
+    LOADGEN_BET = 2,
+    LOADGEN_HIT = 3,
+    LOADGEN_STAND = 4,
+    LOADGEN_ACTION_COUNT = 5,
+    LOADGEN_NONE = -1
+} LoadgenAction;
+
+typedef struct Histogram
+{
+    uint64_t counts[HISTOGRAM_BUCKETS];
+    uint64_t total;
+    uint64_t max;
+} Histogram;
+
+typedef struct LoadgenSession
+{
+    pid_t pid;
+    int fd;
+    bool done;
+    bool failed; // stuck or lost, killed before it finished
+    uint64_t deadline; // next prompt is due by this time
+    char tail[LOADGEN_TAIL_SIZE];
+    size_t tail_length;
+    uint32_t rounds;
+    uint32_t hits;
+    // reply waiting for its think time to pass
+    const char *reply;
+    size_t reply_sent; // bytes of the reply already written
+    LoadgenAction reply_action;
+    uint64_t reply_at;
+    // reply sent, waiting for the game's next prompt
+    LoadgenAction pending_action;
+    uint64_t sent_at;
+} LoadgenSession;
+
+// ** HISTOGRAM FUNCTIONS **
+// records a value (microseconds)
+void histogram_add(Histogram *histogram, uint64_t value);
+// value at or below which the given fraction of values fall
+uint64_t histogram_percentile(const Histogram *histogram, double fraction);
+
+// ** LOAD GENERATOR **
+// "loadgen" subcommand: plays many concurrent games of this program
+// behind pseudo-terminals and reports the latency of every action
+int loadgen_main(int argc, char *argv[]);
+
+#endif
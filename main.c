@@ -8,8 +8,19 @@
 
 #include "card_structs.h"
 #include "card_funcs.h"
+#include "game_structs.h"
+#include "checkpoint.h"
+#include "rng.h"
 #include "delay.h"
 #include "fancy_text.h"
+#include "screen.h"
+#include "game_log.h"
+#include "analyze.h"
+#include "exact_ev.h"
+#include "loadgen.h"
+#include "shared_stats.h"
+#include "outcome_table.h"
+#include "ledger.h"
 
 // *** DEFINES ***
 #define NUM_RANKS (13)
@@ -21,53 +32,12 @@ const uint8_t numCards = NUM_RANKS*NUM_SUITS; // aka 52
 const char *hit_string = "hit\n";
 const char *stand_string = "stand\n";
 
-const char suit_symbols[NUM_SUITS][4] =
-{
-    "♥", "♣", "♦", "♠"
-};
-
-const char suit_names[NUM_SUITS][8] =
-{
-    "Hearts ", "Clubs  ", "Diamond", "Spades "
-};
-
-const char rank_symbols[NUM_RANKS][3] =
-{
-    " A", " 2", " 3", " 4", " 5", " 6", " 7",
-    " 8", " 9", "10", " J", " Q", " K"
-};
-
-const char rank_names[NUM_RANKS][6] =
-{
-    "  Ace", "  Two", "Three", " Four", " Five", "  Six", "Seven",
-    "Eight", " Nine", "  Ten", " Jack", "Queen", " King"
-};
-
-// *** TYPEDEFS ***
-typedef enum RoundOutcome
-{
-    OUTCOME_BROKE = -2,
-    OUTCOME_QUIT = -1,
-    OUTCOME_UNDECIDED = 0,
-    OUTCOME_BLACKJACK = 1, // player wins pot * 2.5
-    OUTCOME_WIN = 2, // player wins pot * 2
-    OUTCOME_LOSE = 3, // no win, pot reset to zero
-    OUTCOME_TIE = 4 // no win, pot not reset
-} RoundOutcome;
-
-typedef struct GameData
-{
-    RoundOutcome round_outcome;
-    uint32_t cash;
-    uint32_t pot;
-    CardList deck;
-    CardList player_hand;
-    CardList dealer_hand;
-} GameData;
-
 // *** FUNCTION DECLARATIONS ***
 // one-time game data initialization (dynamic for the test requirements)
 GameData initialize_data(void);
+// opens the game's account in the ledger & restores the balances recorded in it,
+// returns false if the game can't be played with it
+bool open_ledger(GameData *gameData, const char *path, uint32_t account);
 // game intro message & prompt
 void intro_sequence(void);
 // blackjack outer loop (bet/quit)
@@ -78,17 +48,20 @@ void initialize_round(GameData* gameData);
 // considered extracting hit & stand into separate functions,
 // but concluded that it would only increase complexity.
 void game_loop(GameData* gameData);
+// remembers the player's hand as they hit or stand, for the game log
+void record_decision(GameData *gameData, DecisionAction action);
 // handle outcome, return 0 if no outcome & 1 if round over
 bool handle_outcome(GameData *gameData);
+// ends the game when a ledger entry couldn't be made durable,
+// the balance on screen must never be ahead of the one on disk
+void ledger_failure(GameData *gameData);
 // prints the contents of a card list.
-// Note: this could have been split into 3-4 small "clean" functions,
-// but I chose to determine suit, rank & value as well as
-// print them all in one function, to avoid unnecessary
-// code duplication, keeping it simple & fast.
+// card lines & values come pre-rendered from card_table,
+// so this only sums values and copies lines out.
 int8_t show_hand(CardList *hand, uint16_t stagger, bool showAll);
-// clears the screen & prints the game's "header" text
+// starts a new screen frame with the game's "header" text
 void new_frame(uint16_t stagger);
-// prints the game's "footer" text
+// ends the screen frame with the game's "footer" text & draws it
 void footer(uint16_t stagger);
 // empties stdin to avoid input shenanigans
 void empty_stdin(void);
@@ -96,16 +69,136 @@ void empty_stdin(void);
 /// *** FUNCTION DEFINITIONS ***
 int main(int argc, char *argv[])
 {
-    // set debug mode if argument passed.
-    // currently only exists to print out the deck on init
-    bool debugMode = (argc > 1) && (strcmp("debug", argv[1]) == 0);
+    bool debugMode = false;
+    bool resume = false;
+    const char *checkpointPath = NULL;
+    bool checkpointFailing = false;
+    const char *logPath = NULL;
+    const char *statsPath = NULL;
+    const char *outcomesPath = NULL;
+    const char *ledgerPath = NULL;
+    uint32_t account = 0;
+    bool accountSet = false;
+    uint64_t seed = time(NULL);
+    bool seeded = false;
+
+    // offline tools
+    if (argc > 1 && strcmp("analyze", argv[1]) == 0)
+    {
+        return analyze_main(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp("exact", argv[1]) == 0)
+    {
+        return exact_ev_main(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp("merge", argv[1]) == 0)
+    {
+        return exact_ev_merge_main(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp("loadgen", argv[1]) == 0)
+    {
+        return loadgen_main(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp("stats", argv[1]) == 0)
+    {
+        return shared_stats_main(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp("outcomes", argv[1]) == 0)
+    {
+        return outcome_table_main(argc - 2, argv + 2);
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        // set debug mode if argument passed.
+        // currently only exists to print out the deck on init
+        if (strcmp("debug", argv[i]) == 0) debugMode = true;
+        // save the game state between rounds, for long unattended sessions
+        else if (strcmp("--checkpoint", argv[i]) == 0 && i + 1 < argc) checkpointPath = argv[++i];
+        // continue the game saved in the --checkpoint file
+        else if (strcmp("--resume", argv[i]) == 0) resume = true;
+        // append every decision & its round's result to a log file
+        else if (strcmp("--log", argv[i]) == 0 && i + 1 < argc) logPath = argv[++i];
+        // fixed seed, for reproducible games
+        else if (strcmp("--seed", argv[i]) == 0 && i + 1 < argc)
+        {
+            seed = strtoull(argv[++i], NULL, 10);
+            seeded = true;
+        }
+        // add this game's totals to a statistics file shared by all processes
+        else if (strcmp("--stats", argv[i]) == 0 && i + 1 < argc) statsPath = argv[++i];
+        // add this game's per-state outcome counts to a file on exit
+        else if (strcmp("--outcomes", argv[i]) == 0 && i + 1 < argc) outcomesPath = argv[++i];
+        // keep cash & pot in a durable ledger, restoring them on start
+        else if (strcmp("--ledger", argv[i]) == 0 && i + 1 < argc) ledgerPath = argv[++i];
+        // which of the accounts kept in the --ledger file this game plays
+        else if (strcmp("--account", argv[i]) == 0 && i + 1 < argc)
+        {
+            account = strtoul(argv[++i], NULL, 10);
+            accountSet = true;
+        }
+        // skip all animations & delays, used by the load generator
+        else if (strcmp("--fast", argv[i]) == 0) delay_set_enabled(false);
+    }
+
+    if (resume && checkpointPath == NULL)
+    {
+        printf("--resume needs the --checkpoint file to resume from.\n");
+        return 1;
+    }
+
+    if (accountSet && ledgerPath == NULL)
+    {
+        printf("--account needs the --ledger file it's kept in.\n");
+        return 1;
+    }
+
+    // with real money on the line, the cards must not be known in advance:
+    // a seed can be previewed without the ledger, a checkpoint holds
+    // the rng state & deck order and resuming one replays a round
+    if (ledgerPath != NULL && (seeded || checkpointPath != NULL))
+    {
+        printf("--ledger can't be combined with --seed, --checkpoint or --resume.\n");
+        return 1;
+    }
 
     // initializing game state data
     GameData gameData;
     gameData = initialize_data();
 
     // initializing random seed
-    srand(time(NULL));
+    rng_seed(&gameData.rng_state, seed);
+
+    // allocated before a checkpoint is loaded, which restores its counts
+    if (outcomesPath != NULL) gameData.outcomes = outcome_table_new();
+
+    if (resume && !checkpoint_load(&gameData, checkpointPath))
+    {
+        printf("No valid checkpoint found, starting a new game.\n");
+        delay_ms(1000);
+    }
+
+    // money can't be played for without its record
+    if (ledgerPath != NULL && !open_ledger(&gameData, ledgerPath, account))
+    {
+        cardlist_free(&gameData.deck);
+        cardlist_free(&gameData.player_hand);
+        cardlist_free(&gameData.dealer_hand);
+        free(gameData.outcomes);
+        return 1;
+    }
+
+    if (logPath != NULL && !game_log_open(logPath))
+    {
+        printf("Could not open log file '%s', logging disabled.\n", logPath);
+        delay_ms(1000);
+    }
+
+    if (statsPath != NULL && !shared_stats_open(statsPath))
+    {
+        printf("Could not open statistics file '%s', statistics disabled.\n", statsPath);
+        delay_ms(1000);
+    }
 
     intro_sequence();
 
@@ -114,6 +207,7 @@ int main(int argc, char *argv[])
     {
         show_hand(&gameData.deck, 0, true);
         getchar();
+        screen_invalidate();
     }
 
     // game outer loop (pregame <-> round).
@@ -121,6 +215,19 @@ int main(int argc, char *argv[])
     // decided against it, but it was close.
     while(gameData.round_outcome > -1)
     {
+        // checkpoint between rounds, when the state is complete & consistent
+        // reported when writing starts failing, not on every round after
+        if (checkpointPath != NULL)
+        {
+            bool saved = checkpoint_save(&gameData, checkpointPath);
+
+            if (!saved && !checkpointFailing)
+            {
+                fprintf(stderr, "Failed to write checkpoint '%s', the game can't be resumed from here.\n", checkpointPath);
+            }
+            checkpointFailing = !saved;
+        }
+
         pregame(&gameData);
         if (handle_outcome(&gameData)) continue;
         initialize_round(&gameData);
@@ -130,12 +237,43 @@ int main(int argc, char *argv[])
         game_loop(&gameData);
         handle_outcome(&gameData);
     }
-    
+
+    // DEBUG only: report terminal traffic of the frame redraws
+    if (debugMode)
+    {
+        printf("Screen: %u frames, %llu bytes total, %llu bytes last frame.\n",
+            screen_frame_count(), (unsigned long long)screen_total_bytes(),
+            (unsigned long long)screen_last_frame_bytes());
+    }
+
+    // a finished game has nothing left to resume
+    if (checkpointPath != NULL && gameData.round_outcome == OUTCOME_BROKE)
+    {
+        remove(checkpointPath);
+    }
+
     // free all dynamically allocated memory
     // to match project requirements;
     // in a real-world project I would have
     // allocated the deck statically, which
     // would be both safer and more performant.
+    game_log_close();
+    shared_stats_close();
+
+    if (ledgerPath != NULL)
+    {
+        ledger_close();
+        ledger_report(stdout);
+    }
+
+    if (gameData.outcomes != NULL)
+    {
+        if (!outcome_table_merge_file(gameData.outcomes, outcomesPath))
+        {
+            printf("Could not write outcome table '%s'.\n", outcomesPath);
+        }
+        free(gameData.outcomes);
+    }
     cardlist_free(&gameData.deck);
     cardlist_free(&gameData.player_hand);
     cardlist_free(&gameData.dealer_hand);
@@ -150,6 +288,9 @@ GameData initialize_data(void)
     gameData.round_outcome = OUTCOME_UNDECIDED;
     gameData.cash = 1000;
     gameData.pot = 0;
+    gameData.decision_count = 0;
+    gameData.dealer_total = 0;
+    gameData.outcomes = NULL;
 
     cardlist_init(&gameData.deck);
     cardlist_init(&gameData.player_hand);
@@ -178,10 +319,57 @@ GameData initialize_data(void)
     return gameData;
 }
 
+bool open_ledger(GameData *gameData, const char *path, uint32_t account)
+{
+    uint32_t cash = 0;
+    uint32_t pot = 0;
+    bool recovered = false;
+    bool unsettled = false;
+
+    if (!ledger_open(path, account, &cash, &pot, &recovered, &unsettled))
+    {
+        printf("Could not open account %u of ledger '%s', it may be in use by another game.\n", account, path);
+        return false;
+    }
+
+    // only a brand new account is opened,
+    // a recorded balance is kept even when it's broke
+    if (!recovered)
+    {
+        if (ledger_commit(LEDGER_OPEN, OUTCOME_UNDECIDED, gameData->cash, gameData->cash, gameData->pot)) return true;
+
+        printf("Could not write to ledger '%s'.\n", path);
+        ledger_close();
+        return false;
+    }
+
+    // a round cut off after its bet is lost, pot & all:
+    // its cards may already have been seen, so it's never dealt again
+    if (unsettled)
+    {
+        if (!ledger_commit(LEDGER_SETTLE, OUTCOME_LOSE, 0, cash, 0))
+        {
+            printf("Could not write to ledger '%s'.\n", path);
+            ledger_close();
+            return false;
+        }
+
+        printf("The last round was never finished, its $%u pot is forfeit.\n", pot);
+        pot = 0;
+    }
+
+    gameData->cash = cash;
+    gameData->pot = pot;
+    printf("Restored $%u in cash and $%u in the pot from the ledger.\n", cash, pot);
+    delay_ms(1000);
+
+    return true;
+}
+
 void intro_sequence(void)
 {
     new_frame(8);
-    printf("Welcome to Blackjack!\n");
+    screen_text(0, "Welcome to Blackjack!\n");
     footer(4);
     printf("Press 'Enter' to continue.\n");
     empty_stdin();
@@ -195,8 +383,8 @@ void pregame(GameData* gameData)
     gameData->round_outcome = OUTCOME_UNDECIDED;
 
     new_frame(0);
-    printf("===       BETTING       ===\n\n");
-    printf("You have $%u in cash,\nand the pot is $%u.\n", gameData->cash, gameData->pot);
+    screen_text(0, "===       BETTING       ===\n\n");
+    screen_printf("You have $%u in cash,\nand the pot is $%u.\n", gameData->cash, gameData->pot);
     footer(5);
 
     // no cash + no pot == no game
@@ -215,6 +403,7 @@ void pregame(GameData* gameData)
     {
         printf("Invalid answer, try again.\n");
         footer(0);
+        screen_invalidate();
         inputIsValid = scanf(" %c", &answer);
         empty_stdin();
     }
@@ -229,10 +418,13 @@ void pregame(GameData* gameData)
     inputIsValid = scanf(" %hu", &bet);
     empty_stdin();
     bet *= 10;
+    // both questions & answers take more rows than SCREEN_MARGIN
+    screen_invalidate();
 
     while (inputIsValid == 0 || bet > gameData->cash || bet + gameData->pot <= 0)
     {
         printf("Invalid amount. You may only bet the cash that you have,\nand the pot must be greater than zero.\n10 X ");
+        screen_invalidate();
         inputIsValid = scanf(" %hu", &bet);
         empty_stdin();
         bet *= 10;
@@ -240,13 +432,20 @@ void pregame(GameData* gameData)
 
     gameData->cash -= bet;
     gameData->pot += bet;
+    shared_stats_bet(bet);
+    if (!ledger_commit(LEDGER_BET, OUTCOME_UNDECIDED, bet, gameData->cash, gameData->pot))
+    {
+        ledger_failure(gameData);
+    }
 }
 
 void initialize_round(GameData* gameData)
 {
-    uint8_t cardToDraw;
     uint8_t playerValue;
 
+    gameData->decision_count = 0;
+    gameData->dealer_total = 0;
+
     // if player/dealer hands are not empty,
     // move them back to the deck
     while (gameData->player_hand.length > 0)
@@ -259,25 +458,26 @@ void initialize_round(GameData* gameData)
         MOVE_CARD(&gameData->dealer_hand, &gameData->deck, 0);
     }
 
+    // shuffle once per round, then every card is dealt off the top
+    cardlist_shuffle(&gameData->deck, &gameData->rng_state);
+
     // deal two cards to player hand
     for (int i = 0; i < 2; i++)
     {
-        cardToDraw = rand() % gameData->deck.length;
-        MOVE_CARD(&gameData->deck, &gameData->player_hand, cardToDraw);
+        MOVE_CARD(&gameData->deck, &gameData->player_hand, 0);
     }
 
     // deal two cards to dealer hand
     for (int i = 0; i < 2; i++)
     {
-        cardToDraw = rand() % gameData->deck.length;
-        MOVE_CARD(&gameData->deck, &gameData->dealer_hand, cardToDraw);
+        MOVE_CARD(&gameData->deck, &gameData->dealer_hand, 0);
     }
 
     new_frame(0);
-    printf("-==-===  NEW ROUND  ===-==-\n\nPlayer initial hand:\n");
+    screen_text(0, "-==-===  NEW ROUND  ===-==-\n\nPlayer initial hand:\n");
     playerValue = show_hand(&gameData->player_hand, 100, 1);
-    printf("\n");
-    delay_ms(100);
+    screen_text(0, "\n");
+    screen_pause(100);
 
     if (playerValue == 21)
     // if exactly 21 player wins
@@ -286,7 +486,7 @@ void initialize_round(GameData* gameData)
         return;
     }
 
-    printf("Dealer initial hand:\n");
+    screen_text(0, "Dealer initial hand:\n");
     show_hand(&gameData->dealer_hand, 150, 0);
     footer(4);
 }
@@ -294,7 +494,6 @@ void initialize_round(GameData* gameData)
 void game_loop(GameData* gameData)
 {
     bool newPhase = true;
-    uint8_t pick = 0;
     uint8_t playerValue = 0;
     uint8_t dealerValue = 0;
     char reset_string[10] = "\0\0\0\0\0\0\0\0\0\0";
@@ -312,18 +511,18 @@ void game_loop(GameData* gameData)
         if (strcmp(input, hit_string) == 0)
         {
             // HIT: player draws another card
-            pick = rand() % gameData->deck.length;
+            record_decision(gameData, ACTION_HIT);
             new_frame(0);
-            stagger_string(newPhase ? 5 : 0, "===         HIT         ===\n\n");
-            flash_text(3, 300, "Dealing card to player!");
-            MOVE_CARD(&gameData->deck, &gameData->player_hand, pick);
-            delay_ms(50);
+            screen_text(newPhase ? 5 : 0, "===         HIT         ===\n\n");
+            screen_flash(3, 300, "Dealing card to player!");
+            MOVE_CARD(&gameData->deck, &gameData->player_hand, 0);
+            screen_pause(50);
 
             // total value is recalculated
-            stagger_string(10, "\n\nPlayer hand:\n");
+            screen_text(10, "\n\nPlayer hand:\n");
             playerValue = show_hand(&gameData->player_hand, 250, 1);
-            printf("\n");
-            delay_ms(250);
+            screen_text(0, "\n");
+            screen_pause(250);
 
             // if over 21 player loses
             if (playerValue > 21)
@@ -340,7 +539,7 @@ void game_loop(GameData* gameData)
 
             // else, dealer hand is reprinted,
             // and loop restarts
-            stagger_string(0, "Dealer hand:\n");
+            screen_text(0, "Dealer hand:\n");
             dealerValue = show_hand(&gameData->dealer_hand, 50, 0);
             footer(4);
 
@@ -350,11 +549,13 @@ void game_loop(GameData* gameData)
         {
             // STAND: loop breaks and we continue
             // to DEALER DRAW
+            record_decision(gameData, ACTION_STAND);
             break;
         }
         else
         {
             printf("Invalid input, please try again.\n");
+            screen_invalidate();
         }
 
         newPhase = false;
@@ -367,11 +568,11 @@ void game_loop(GameData* gameData)
     for(;;)
     {
         new_frame(0);
-        stagger_string(newPhase ? 5 : 0, "===    DEALER   DRAW    ===\n\nPlayer hand:\n");
+        screen_text(newPhase ? 5 : 0, "===    DEALER   DRAW    ===\n\nPlayer hand:\n");
         playerValue = show_hand(&gameData->player_hand, 0, 1);
-        delay_ms(newPhase ? 20 : 200);
+        screen_pause(newPhase ? 20 : 200);
 
-        stagger_string(newPhase ? 0 : 10, "\nDealer hand:\n");
+        screen_text(newPhase ? 0 : 10, "\nDealer hand:\n");
         dealerValue = show_hand(&gameData->dealer_hand, newPhase ? 100 : 400, 1);
         footer(9);
 
@@ -382,11 +583,12 @@ void game_loop(GameData* gameData)
         stagger_string(10, "\r                    ");
         flash_text(3, 350, dealer_draw_text);
         delay_ms(50);
-        pick = rand() % gameData->deck.length;
-        MOVE_CARD(&gameData->deck, &gameData->dealer_hand, pick);
+        MOVE_CARD(&gameData->deck, &gameData->dealer_hand, 0);
         newPhase = false;
     }
 
+    gameData->dealer_total = dealerValue;
+
     // if it's over 21, player wins
     if (dealerValue > 21)
     {
@@ -416,6 +618,18 @@ void game_loop(GameData* gameData)
     gameData->round_outcome = OUTCOME_WIN;
 }
 
+void record_decision(GameData *gameData, DecisionAction action)
+{
+    bool soft = false;
+
+    if (gameData->decision_count >= MAX_DECISIONS) return;
+
+    RoundDecision *decision = &gameData->decisions[gameData->decision_count++];
+    decision->player_total = cardlist_value(&gameData->player_hand, &soft);
+    decision->soft = soft;
+    decision->action = action;
+}
+
 bool handle_outcome(GameData *gameData)
 {
     uint32_t winning = 0;
@@ -446,14 +660,20 @@ bool handle_outcome(GameData *gameData)
         {125, "\aman!\n"}
     };
 
+    // rounds that end mid-frame still have it waiting to be drawn
+    screen_present();
+
     switch (gameData->round_outcome)
     {
         case OUTCOME_BROKE:
+            shared_stats_outcome(gameData->round_outcome, 0);
             stagger_text_variable(8, tsvc_broke);
             footer(7);
             return 1;
         case OUTCOME_QUIT:
+            shared_stats_outcome(gameData->round_outcome, 0);
             new_frame(0);
+            screen_present();
             stagger_text_variable(2, tsvc_quit);
             footer(5);
             return 1;
@@ -461,8 +681,14 @@ bool handle_outcome(GameData *gameData)
             return 0;
         case OUTCOME_BLACKJACK:
             winning = gameData->pot * 2.5f;
+            game_log_round(gameData, winning - gameData->pot);
             gameData->cash += winning;
             gameData->pot = 0;
+            if (!ledger_commit(LEDGER_SETTLE, gameData->round_outcome, winning, gameData->cash, gameData->pot))
+            {
+                ledger_failure(gameData);
+                return 1;
+            }
             stagger_string(10, blackjack_text);
             stagger_string(20, "\r         \r");
             stagger_string(30, blackjack_text);
@@ -473,19 +699,37 @@ bool handle_outcome(GameData *gameData)
             break;
         case OUTCOME_WIN:
             winning = gameData->pot * 2;
+            game_log_round(gameData, winning - gameData->pot);
             gameData->cash += winning;
             gameData->pot = 0;
+            if (!ledger_commit(LEDGER_SETTLE, gameData->round_outcome, winning, gameData->cash, gameData->pot))
+            {
+                ledger_failure(gameData);
+                return 1;
+            }
             stagger_text_variable(6, tsvc_player_win);
             printf("You won $%u.\n", winning);
             delay_ms(100);
             break;
         case OUTCOME_LOSE:
+            game_log_round(gameData, -(int32_t)gameData->pot);
+            gameData->pot = 0;
+            if (!ledger_commit(LEDGER_SETTLE, gameData->round_outcome, 0, gameData->cash, gameData->pot))
+            {
+                ledger_failure(gameData);
+                return 1;
+            }
             printf("\aToo bad, you lost.\n");
             delay_ms(200);
             stagger_string(20, "\aBetter luck next time.\n");
-            gameData->pot = 0;
             break;
         case OUTCOME_TIE:
+            game_log_round(gameData, 0);
+            if (!ledger_commit(LEDGER_SETTLE, gameData->round_outcome, 0, gameData->cash, gameData->pot))
+            {
+                ledger_failure(gameData);
+                return 1;
+            }
             printf("\aIt's a tie!");
             stagger_string(30, " Money's still on the table...\n");
             break;
@@ -495,6 +739,9 @@ bool handle_outcome(GameData *gameData)
     }
 
 
+    shared_stats_outcome(gameData->round_outcome, winning);
+    if (gameData->outcomes != NULL) outcome_table_add_round(gameData->outcomes, gameData);
+
     if (gameData->round_outcome > 0)
     {
         printf("\n-♥♣♦♠   ROUND  OVER  ♠♦♣♥-\n\n");
@@ -502,45 +749,43 @@ bool handle_outcome(GameData *gameData)
 
     printf("Press 'Enter' to continue.\n");
     empty_stdin();
+    screen_invalidate();
 
     return 1;
 }
 
+void ledger_failure(GameData *gameData)
+{
+    printf("\aThe ledger could not be written, the game has to stop here.\n");
+    printf("Your balance is the one of the last completed entry.\n");
+    gameData->round_outcome = OUTCOME_QUIT;
+}
+
 int8_t show_hand(CardList *hand, uint16_t stagger, bool showAll)
 {
     uint16_t total = 0;
     uint8_t aces = 0;
     uint16_t count = 0;
+    static const char hidden_card_text[] = " [ ? ]  ?\?\?  of   ?\?\?   (?\?)\n";
 
     Card *current = hand->head;
 
     while(current != NULL)
     {
-        delay_ms(stagger + count + total * (current->next == NULL ? 2 : 1));
-
-        uint8_t rank = current->data >> 4;
-        uint8_t suit_byte = (uint8_t)(current->data << 4);
-        uint8_t suit = 0;
-        uint8_t value = rank+1;
+        screen_pause(stagger + count + total * (current->next == NULL ? 2 : 1));
 
-        if (value > 10) value = 10;
-        else if (value == 1) aces++;
+        const CardInfo *info = &card_table[current->data];
 
-        total += value;
-
-        while(suit_byte > 16)
-        {
-            suit_byte /= 2;
-            suit++;
-        }
+        if (info->rank == 0) aces++;
+        total += info->value;
 
         if (showAll || count == 0)
         {
-            printf(" [%s%s] %s of %s (%2d)\n", rank_symbols[rank], suit_symbols[suit], rank_names[rank], suit_names[suit], value);
+            screen_write(info->text, info->length);
         }
         else
         {
-            printf(" [ ? ]  ?\??  of   ?\??   (?\?)\n");
+            screen_write(hidden_card_text, sizeof(hidden_card_text) - 1);
         }
 
         current = current->next;
@@ -558,18 +803,18 @@ int8_t show_hand(CardList *hand, uint16_t stagger, bool showAll)
     {
         if (stagger)
         {
-            printf("Total: ");
-            run_up_number_2d(80, total, 21);
-            printf("\n");
+            screen_text(0, "Total: ");
+            screen_run_up(80, total, 21);
+            screen_text(0, "\n");
         }
         else
         {
-            printf("Total: [%hu]\n", total);
+            screen_printf("Total: [%hu]\n", total);
         }
     }
     else
     {
-        printf("Total: [??]\n");
+        screen_text(0, "Total: [??]\n");
     }
 
     return total;
@@ -577,37 +822,18 @@ int8_t show_hand(CardList *hand, uint16_t stagger, bool showAll)
 
 void new_frame(uint16_t stagger)
 {
-    #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
-        system("clear");
-    #endif
-    #if defined(_WIN32) || defined(_WIN64)
-        system("cls");
-    #endif
-
     static const char *text = "=======  BLACKJACK  =======\n\n";
 
-    if (stagger)
-    {
-        stagger_string(stagger, text);
-    }
-    else
-    {
-        printf("%s", text);
-    }
+    screen_begin();
+    screen_text(stagger, text);
 }
 
 void footer(uint16_t stagger)
 {
     static const char *text = "\n-====♥♣♦♠♥♣♦♠♥♠♦♣♥♠♦♣♥====-\n\n";
 
-    if (stagger)
-    {
-        stagger_string(stagger, text);
-    }
-    else
-    {
-        printf("%s", text);
-    }
+    screen_text(stagger, text);
+    screen_present();
 }
 
 void empty_stdin (void)
@@ -0,0 +1,295 @@
+#include "outcome_table.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include "card_funcs.h"
+#include "util.h"
+
+// magic, version, cell count & counters per cell, followed by the encoded table
+#define OUTCOME_FILE_HEADER_SIZE (4 + 3 * 4)
+
+static const char outcome_table_magic[4] = { 'B', 'J', 'O', 'T' };
+
+static uint8_t dealer_bucket(uint8_t dealerTotal)
+{
+    if (dealerTotal == 0) return 0;
+    if (dealerTotal < 17) return 1;
+    if (dealerTotal > 21) return 7;
+    return dealerTotal - 15;
+}
+
+OutcomeTable *outcome_table_new(void)
+{
+    void *table = NULL;
+
+    if (posix_memalign(&table, 64, sizeof(OutcomeTable)) != 0) return NULL;
+    memset(table, 0, sizeof(OutcomeTable));
+
+    return table;
+}
+
+void outcome_table_add(OutcomeTable *table, uint8_t total, uint8_t soft, uint8_t upcard,
+    uint8_t action, RoundOutcome outcome, uint8_t dealerTotal)
+{
+    if (total >= OUTCOME_TOTALS || soft > 1 || upcard < 1 || upcard > OUTCOME_UPCARDS
+        || action >= OUTCOME_ACTIONS || outcome < OUTCOME_BLACKJACK || outcome > OUTCOME_TIE) return;
+
+    OutcomeCell *cell = &table->cells[soft][total][upcard - 1][action];
+    cell->results[outcome - OUTCOME_BLACKJACK]++;
+    cell->dealer[dealer_bucket(dealerTotal)]++;
+}
+
+void outcome_table_add_round(OutcomeTable *table, const GameData *gameData)
+{
+    if (gameData->dealer_hand.head == NULL) return;
+
+    uint8_t upcard = card_table[gameData->dealer_hand.head->data].value;
+
+    for (uint8_t i = 0; i < gameData->decision_count; i++)
+    {
+        const RoundDecision *decision = &gameData->decisions[i];
+        outcome_table_add(table, decision->player_total, decision->soft, upcard,
+            decision->action, gameData->round_outcome, gameData->dealer_total);
+    }
+}
+
+void outcome_table_merge(OutcomeTable *dst, const OutcomeTable *src)
+{
+    uint64_t *to = &dst->cells[0][0][0][0].results[0];
+    const uint64_t *from = &src->cells[0][0][0][0].results[0];
+
+    for (size_t i = 0; i < sizeof(OutcomeTable) / sizeof(uint64_t); i++)
+    {
+        to[i] += from[i];
+    }
+}
+
+size_t outcome_table_encode(const OutcomeTable *table, uint8_t *buf)
+{
+    const OutcomeCell *cells = &table->cells[0][0][0][0];
+    uint32_t used = 0;
+    size_t size = 4;
+
+    for (uint32_t i = 0; i < OUTCOME_CELL_COUNT; i++)
+    {
+        const uint64_t *counters = cells[i].results;
+        bool empty = true;
+
+        for (int c = 0; c < OUTCOME_CELL_COUNTERS && empty; c++) empty = counters[c] == 0;
+        if (empty) continue;
+
+        size += put_uint(buf + size, i, 4);
+        for (int c = 0; c < OUTCOME_RESULTS; c++) size += put_uint(buf + size, cells[i].results[c], 8);
+        for (int c = 0; c < OUTCOME_DEALER_BUCKETS; c++) size += put_uint(buf + size, cells[i].dealer[c], 8);
+        used++;
+    }
+
+    put_uint(buf, used, 4);
+
+    return size;
+}
+
+size_t outcome_table_decode(OutcomeTable *table, const uint8_t *buf, size_t size)
+{
+    const size_t cellSize = 4 + OUTCOME_CELL_COUNTERS * 8;
+    OutcomeCell *cells = &table->cells[0][0][0][0];
+
+    if (size < 4) return 0;
+
+    uint64_t used = get_uint(buf, 4);
+    if (used > OUTCOME_CELL_COUNT || size < 4 + used * cellSize) return 0;
+
+    for (uint64_t n = 0; n < used; n++)
+    {
+        const uint8_t *cell = buf + 4 + n * cellSize;
+        uint64_t i = get_uint(cell, 4);
+        if (i >= OUTCOME_CELL_COUNT) return 0;
+
+        for (int c = 0; c < OUTCOME_RESULTS; c++) cells[i].results[c] += get_uint(cell + 4 + c * 8, 8);
+        for (int c = 0; c < OUTCOME_DEALER_BUCKETS; c++)
+        {
+            cells[i].dealer[c] += get_uint(cell + 4 + (OUTCOME_RESULTS + c) * 8, 8);
+        }
+    }
+
+    return 4 + used * cellSize;
+}
+
+bool outcome_table_load(OutcomeTable *table, const char *path)
+{
+    const size_t maxSize = OUTCOME_FILE_HEADER_SIZE + OUTCOME_ENCODED_MAX_SIZE;
+    bool ok = false;
+
+    OutcomeTable *loaded = outcome_table_new();
+    uint8_t *buf = malloc(maxSize + 1);
+    FILE *file = fopen(path, "rb");
+
+    if (loaded != NULL && buf != NULL && file != NULL)
+    {
+        size_t size = fread(buf, 1, maxSize + 1, file);
+
+        // a table is only taken whole, it must fill the file exactly
+        ok = size >= OUTCOME_FILE_HEADER_SIZE && size <= maxSize
+            && memcmp(buf, outcome_table_magic, sizeof(outcome_table_magic)) == 0
+            && get_uint(buf + 4, 4) == OUTCOME_TABLE_VERSION
+            && get_uint(buf + 8, 4) == OUTCOME_CELL_COUNT
+            && get_uint(buf + 12, 4) == OUTCOME_CELL_COUNTERS
+            && outcome_table_decode(loaded, buf + OUTCOME_FILE_HEADER_SIZE, size - OUTCOME_FILE_HEADER_SIZE)
+                == size - OUTCOME_FILE_HEADER_SIZE;
+    }
+
+    if (file != NULL) fclose(file);
+    if (ok) outcome_table_merge(table, loaded);
+    free(buf);
+    free(loaded);
+
+    return ok;
+}
+
+bool outcome_table_save(const OutcomeTable *table, const char *path)
+{
+    size_t size = 0;
+
+    uint8_t *buf = malloc(OUTCOME_FILE_HEADER_SIZE + OUTCOME_ENCODED_MAX_SIZE);
+    if (buf == NULL) return false;
+
+    memcpy(buf, outcome_table_magic, sizeof(outcome_table_magic));
+    size += sizeof(outcome_table_magic);
+    size += put_uint(buf + size, OUTCOME_TABLE_VERSION, 4);
+    size += put_uint(buf + size, OUTCOME_CELL_COUNT, 4);
+    size += put_uint(buf + size, OUTCOME_CELL_COUNTERS, 4);
+    size += outcome_table_encode(table, buf + size);
+
+    bool ok = write_file_atomic(path, buf, size);
+    free(buf);
+
+    return ok;
+}
+
+bool outcome_table_merge_file(const OutcomeTable *table, const char *path)
+{
+    char lockPath[256];
+
+    // the file itself is replaced by the rename, so the lock lives next to it
+    // and is held from the load through the rename
+    if (snprintf(lockPath, sizeof(lockPath), "%s.lock", path) >= (int)sizeof(lockPath)) return false;
+
+    int lockFd = open(lockPath, O_RDWR | O_CREAT, 0644);
+    if (lockFd < 0) return false;
+
+    if (flock(lockFd, LOCK_EX) != 0)
+    {
+        close(lockFd);
+        return false;
+    }
+
+    OutcomeTable *merged = outcome_table_new();
+    if (merged == NULL)
+    {
+        close(lockFd);
+        return false;
+    }
+
+    memcpy(merged, table, sizeof(OutcomeTable));
+
+    // a missing file just starts from zero, but a bad one is kept as is
+    FILE *existing = fopen(path, "rb");
+    bool ok = true;
+    if (existing != NULL)
+    {
+        fclose(existing);
+        ok = outcome_table_load(merged, path);
+    }
+
+    ok = ok && outcome_table_save(merged, path);
+    free(merged);
+    // closing drops the lock
+    close(lockFd);
+
+    return ok;
+}
+
+void outcome_table_write_csv(const OutcomeTable *table, FILE *out)
+{
+    static const char *action_names[OUTCOME_ACTIONS] = { "hit", "stand" };
+
+    fprintf(out, "soft,total,upcard,action,blackjack,win,lose,tie,"
+        "dealer_none,dealer_under_17,dealer_17,dealer_18,dealer_19,dealer_20,dealer_21,dealer_bust\n");
+
+    for (int soft = 0; soft < 2; soft++)
+    {
+        for (int total = 0; total < OUTCOME_TOTALS; total++)
+        {
+            for (int upcard = 0; upcard < OUTCOME_UPCARDS; upcard++)
+            {
+                for (int action = 0; action < OUTCOME_ACTIONS; action++)
+                {
+                    const OutcomeCell *cell = &table->cells[soft][total][upcard][action];
+                    uint64_t count = 0;
+
+                    for (int i = 0; i < OUTCOME_RESULTS; i++) count += cell->results[i];
+                    if (count == 0) continue;
+
+                    fprintf(out, "%d,%d,%d,%s", soft, total, upcard + 1, action_names[action]);
+                    for (int i = 0; i < OUTCOME_RESULTS; i++)
+                    {
+                        fprintf(out, ",%llu", (unsigned long long)cell->results[i]);
+                    }
+                    for (int i = 0; i < OUTCOME_DEALER_BUCKETS; i++)
+                    {
+                        fprintf(out, ",%llu", (unsigned long long)cell->dealer[i]);
+                    }
+                    fprintf(out, "\n");
+                }
+            }
+        }
+    }
+}
+
+int outcome_table_main(int argc, char *argv[])
+{
+    const char *outPath = NULL;
+    int files = 0;
+
+    OutcomeTable *table = outcome_table_new();
+    if (table == NULL) return 1;
+
+    for (int i = 0; i < argc; i++)
+    {
+        if (strcmp("-o", argv[i]) == 0 && i + 1 < argc)
+        {
+            outPath = argv[++i];
+            continue;
+        }
+
+        if (!outcome_table_load(table, argv[i]))
+        {
+            fprintf(stderr, "Could not read outcome table '%s'.\n", argv[i]);
+            free(table);
+            return 1;
+        }
+        files++;
+    }
+
+    if (files == 0)
+    {
+        printf("Usage: prog outcomes <outcome file>... [-o merged file]\n");
+        free(table);
+        return 1;
+    }
+
+    if (outPath != NULL && !outcome_table_save(table, outPath))
+    {
+        fprintf(stderr, "Could not write outcome table '%s'.\n", outPath);
+        free(table);
+        return 1;
+    }
+
+    outcome_table_write_csv(table, stdout);
+    free(table);
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+#ifndef OUTCOME_TABLE_H
+#define OUTCOME_TABLE_H
+
+    #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#define _GNU_SOURCE
+    #endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_structs.h"
+
+#define OUTCOME_TABLE_VERSION (2)
+// decisions are only made below 21
+#define OUTCOME_TOTALS (21)
+#define OUTCOME_UPCARDS (10)
+#define OUTCOME_ACTIONS (2)
+// blackjack, win, lose & tie
+#define OUTCOME_RESULTS (4)
+// dealer didn't play, under 17, 17 to 21 & bust
+#define OUTCOME_DEALER_BUCKETS (8)
+
+typedef struct OutcomeCell
+{
+    uint64_t results[OUTCOME_RESULTS]; // indexed by RoundOutcome - 1
+    uint64_t dealer[OUTCOME_DEALER_BUCKETS];
+} OutcomeCell;
+
+// dense counters for every (soft, total, upcard, action),
+// addressed directly so an update is a few increments, never a lookup.
+// its size is fixed, however many rounds are counted into it.
+typedef struct OutcomeTable
+{
+    OutcomeCell cells[2][OUTCOME_TOTALS][OUTCOME_UPCARDS][OUTCOME_ACTIONS];
+} __attribute__((aligned(64))) OutcomeTable;
+
+#define OUTCOME_CELL_COUNT (sizeof(OutcomeTable) / sizeof(OutcomeCell))
+#define OUTCOME_CELL_COUNTERS (OUTCOME_RESULTS + OUTCOME_DEALER_BUCKETS)
+// encoded table: non-empty cell count, then each such cell's index & counters,
+// all little-endian so files can be merged across machines
+#define OUTCOME_ENCODED_MAX_SIZE (4 + OUTCOME_CELL_COUNT * (4 + OUTCOME_CELL_COUNTERS * 8))
+
+// ** OUTCOME TABLE FUNCTIONS **
+// allocates a zeroed, cache-aligned table
+OutcomeTable *outcome_table_new(void);
+// counts one decision. upcard is 1 (ace) to 10,
+// dealerTotal is the dealer's final total or 0 if the dealer didn't play.
+void outcome_table_add(OutcomeTable *table, uint8_t total, uint8_t soft, uint8_t upcard,
+    uint8_t action, RoundOutcome outcome, uint8_t dealerTotal);
+// counts every decision of a settled round
+void outcome_table_add_round(OutcomeTable *table, const GameData *gameData);
+// adds the counts of src into dst
+void outcome_table_merge(OutcomeTable *dst, const OutcomeTable *src);
+// writes the non-empty cells of table to buf (OUTCOME_ENCODED_MAX_SIZE at most),
+// returns the encoded size
+size_t outcome_table_encode(const OutcomeTable *table, uint8_t *buf);
+// adds encoded counts into table, returns the encoded size or 0 if buf is invalid,
+// in which case table may hold part of the counts
+size_t outcome_table_decode(OutcomeTable *table, const uint8_t *buf, size_t size);
+// adds the counts stored in a file into table
+bool outcome_table_load(OutcomeTable *table, const char *path);
+// writes table to a file, atomically replacing it
+bool outcome_table_save(const OutcomeTable *table, const char *path);
+// adds table to the counts already in a file (or creates it),
+// holding an exclusive lock on "<path>.lock" so concurrent merges all count
+bool outcome_table_merge_file(const OutcomeTable *table, const char *path);
+// writes the non-empty cells as CSV
+void outcome_table_write_csv(const OutcomeTable *table, FILE *out);
+// "outcomes" subcommand: merges outcome files & prints them as CSV
+int outcome_table_main(int argc, char *argv[]);
+
+#endif
@@ -0,0 +1,20 @@
+#include "rng.h"
+
+void rng_seed(uint64_t *state, uint64_t seed)
+{
+    *state = seed;
+}
+
+uint64_t rng_next(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+uint32_t rng_range(uint64_t *state, uint32_t range)
+{
+    // multiply-shift keeps the bias negligible for our tiny ranges
+    return (uint32_t)(((rng_next(state) >> 32) * range) >> 32);
+}
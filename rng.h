@@ -0,0 +1,17 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// ** RANDOM NUMBER GENERATOR **
+// small self-contained generator (splitmix64) used instead of rand(),
+// so that its entire state is a single integer that can be saved & restored.
+
+// seeds a generator state
+void rng_seed(uint64_t *state, uint64_t seed);
+// advances the state and returns the next 64 random bits
+uint64_t rng_next(uint64_t *state);
+// returns a random number in the range [0, range)
+uint32_t rng_range(uint64_t *state, uint32_t range);
+
+#endif
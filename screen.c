@@ -0,0 +1,347 @@
+#include "screen.h"
+
+    #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#include <sys/ioctl.h>
+#include <unistd.h>
+    #endif
+
+static ScreenRow front[SCREEN_MAX_ROWS];
+static ScreenRow back[SCREEN_MAX_ROWS];
+static uint16_t front_rows = 0;
+static uint16_t current_row = 0;
+static bool front_valid = false;
+static bool frame_open = false;
+
+static uint32_t frame_count = 0;
+static uint64_t frame_bytes = 0;
+static uint64_t last_frame_bytes = 0;
+static uint64_t total_bytes = 0;
+
+static uint16_t terminal_rows(void)
+{
+    #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+        struct winsize size;
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0)
+        {
+            return size.ws_row;
+        }
+    #endif
+
+    return 24;
+}
+
+// all escape sequences & plain text go through here to be counted
+static void emit(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int written = vprintf(format, args);
+    va_end(args);
+
+    if (written > 0) frame_bytes += written;
+}
+
+static void emit_raw(const char *text, size_t length)
+{
+    frame_bytes += fwrite(text, 1, length, stdout);
+}
+
+// on-screen width of the first length bytes of a row.
+// every glyph used by the game is a single column wide,
+// so this is the number of code points, minus control characters.
+static uint16_t columns(const char *text, uint16_t length)
+{
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < length; i++)
+    {
+        unsigned char c = (unsigned char)text[i];
+        if ((c & 0xC0) != 0x80 && c >= 0x20) count++;
+    }
+    return count;
+}
+
+static bool rows_equal(const ScreenRow *a, const ScreenRow *b)
+{
+    return a->length == b->length && memcmp(a->text, b->text, a->length) == 0;
+}
+
+static void append(uint16_t delay, const char *text, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        ScreenRow *row = &back[current_row];
+
+        if (text[i] == '\n')
+        {
+            // rows past the limit are dropped, keeping the last one open
+            if (current_row + 1 < SCREEN_MAX_ROWS)
+            {
+                current_row++;
+                memset(&back[current_row], 0, sizeof(ScreenRow));
+            }
+            continue;
+        }
+
+        if (text[i] == '\r') continue;
+
+        if (row->length < SCREEN_ROW_SIZE - 1)
+        {
+            row->text[row->length++] = text[i];
+            if (delay > row->delay) row->delay = delay;
+        }
+    }
+}
+
+// shifts the front buffer (and the terminal) with insert/delete line
+// when the new frame is the old one with rows added or removed in
+// the middle, e.g. a card drawn into a hand above other rows
+static void match_shift(uint16_t rows)
+{
+    uint16_t first = 0;
+    uint16_t common = rows < front_rows ? rows : front_rows;
+    uint16_t matchesStill = 0;
+    uint16_t matchesShifted = 0;
+
+    while (first < common && rows_equal(&back[first], &front[first])) first++;
+    if (first >= common) return;
+
+    if (rows > front_rows)
+    {
+        uint16_t shift = rows - front_rows;
+
+        for (uint16_t i = first; i < front_rows; i++)
+        {
+            matchesStill += rows_equal(&back[i], &front[i]);
+            matchesShifted += rows_equal(&back[i + shift], &front[i]);
+        }
+
+        if (matchesShifted <= matchesStill) return;
+
+        emit("\x1b[%u;1H\x1b[%uL", first + 1, shift);
+        memmove(&front[first + shift], &front[first], sizeof(ScreenRow) * (front_rows - first));
+        memset(&front[first], 0, sizeof(ScreenRow) * shift);
+        front_rows = rows;
+    }
+    else if (rows < front_rows)
+    {
+        uint16_t shift = front_rows - rows;
+
+        for (uint16_t i = first; i < rows; i++)
+        {
+            matchesStill += rows_equal(&back[i], &front[i]);
+            matchesShifted += rows_equal(&back[i], &front[i + shift]);
+        }
+
+        if (matchesShifted <= matchesStill) return;
+
+        emit("\x1b[%u;1H\x1b[%uM", first + 1, shift);
+        memmove(&front[first], &front[first + shift], sizeof(ScreenRow) * (front_rows - first - shift));
+        front_rows = rows;
+    }
+}
+
+static void draw_row(uint16_t index)
+{
+    ScreenRow *row = &back[index];
+    ScreenRow *old = index < front_rows ? &front[index] : NULL;
+    uint16_t start = 0;
+    bool clearTail = (old == NULL) || columns(old->text, old->length) > columns(row->text, row->length);
+
+    // plain rows only redraw from the first changed character
+    if (old != NULL && row->effect == EFFECT_NONE)
+    {
+        while (start < row->length && start < old->length && row->text[start] == old->text[start]) start++;
+        while (start > 0 && ((unsigned char)row->text[start] & 0xC0) == 0x80) start--;
+    }
+
+    emit("\x1b[%u;%uH", index + 1, columns(row->text, start) + 1);
+    fflush(stdout);
+    delay_ms(row->pause);
+
+    uint64_t fancyBefore = fancy_text_bytes_written();
+
+    switch (row->effect)
+    {
+        case EFFECT_FLASH:
+            row->text[row->length] = '\0';
+            flash_text(row->flash_reps, row->flash_delay, row->text);
+            break;
+        case EFFECT_RUN_UP:
+            emit_raw(row->text, row->run_up_offset);
+            run_up_number_2d(row->run_up_delay, row->run_up_number, row->run_up_drama);
+            break;
+        case EFFECT_NONE:
+        default:
+            if (row->delay)
+            {
+                row->text[row->length] = '\0';
+                stagger_string(row->delay, row->text + start);
+            }
+            else
+            {
+                emit_raw(row->text + start, row->length - start);
+            }
+            break;
+    }
+
+    frame_bytes += fancy_text_bytes_written() - fancyBefore;
+
+    if (clearTail) emit("\x1b[K");
+}
+
+void screen_begin(void)
+{
+    if (frame_open) screen_present();
+
+    frame_open = true;
+    current_row = 0;
+    memset(&back[0], 0, sizeof(ScreenRow));
+}
+
+void screen_text(uint16_t delay, const char *text)
+{
+    if (!frame_open)
+    {
+        stagger_string(delay, text);
+        return;
+    }
+
+    append(delay, text, strlen(text));
+}
+
+void screen_write(const char *text, size_t length)
+{
+    if (!frame_open)
+    {
+        fwrite(text, 1, length, stdout);
+        return;
+    }
+
+    append(0, text, length);
+}
+
+void screen_printf(const char *format, ...)
+{
+    char buffer[SCREEN_ROW_SIZE * 2];
+    va_list args;
+    va_start(args, format);
+
+    if (!frame_open)
+    {
+        vprintf(format, args);
+    }
+    else
+    {
+        int length = vsnprintf(buffer, sizeof(buffer), format, args);
+        if (length > (int)sizeof(buffer) - 1) length = sizeof(buffer) - 1;
+        if (length > 0) append(0, buffer, length);
+    }
+
+    va_end(args);
+}
+
+void screen_pause(uint16_t ms)
+{
+    if (!frame_open)
+    {
+        delay_ms(ms);
+        return;
+    }
+
+    back[current_row].pause += ms;
+}
+
+void screen_flash(uint8_t reps, uint32_t delay, const char *text)
+{
+    if (!frame_open)
+    {
+        flash_text(reps, delay, text);
+        return;
+    }
+
+    ScreenRow *row = &back[current_row];
+    append(0, text, strlen(text));
+    row->effect = EFFECT_FLASH;
+    row->flash_reps = reps;
+    row->flash_delay = delay;
+}
+
+void screen_run_up(uint16_t delay, uint32_t number, uint32_t dramaNumber)
+{
+    if (!frame_open)
+    {
+        run_up_number_2d(delay, number, dramaNumber);
+        return;
+    }
+
+    ScreenRow *row = &back[current_row];
+    uint16_t offset = row->length;
+    screen_printf("%2u", number);
+    row->effect = EFFECT_RUN_UP;
+    row->run_up_offset = offset;
+    row->run_up_delay = delay;
+    row->run_up_number = number;
+    row->run_up_drama = dramaNumber;
+}
+
+void screen_present(void)
+{
+    if (!frame_open) return;
+    frame_open = false;
+    frame_bytes = 0;
+
+    // an open last row only counts if something was written to it
+    uint16_t rows = current_row + (back[current_row].length > 0 ? 1 : 0);
+
+    // a frame that could scroll the terminal can't be tracked
+    bool fits = current_row + 1 + SCREEN_MARGIN <= terminal_rows();
+
+    if (!front_valid || !fits)
+    {
+        emit("\x1b[H\x1b[2J");
+        front_rows = 0;
+    }
+    else
+    {
+        match_shift(rows);
+    }
+
+    for (uint16_t i = 0; i < rows; i++)
+    {
+        if (i < front_rows && rows_equal(&back[i], &front[i])) continue;
+        draw_row(i);
+    }
+
+    // leave the cursor where the frame's text ended,
+    // and clear whatever was printed below the last frame
+    emit("\x1b[%u;%uH\x1b[J", current_row + 1, columns(back[current_row].text, back[current_row].length) + 1);
+    fflush(stdout);
+
+    memcpy(front, back, sizeof(ScreenRow) * rows);
+    front_rows = rows;
+    front_valid = fits;
+
+    frame_count++;
+    last_frame_bytes = frame_bytes;
+    total_bytes += frame_bytes;
+}
+
+void screen_invalidate(void)
+{
+    front_valid = false;
+}
+
+uint32_t screen_frame_count(void)
+{
+    return frame_count;
+}
+
+uint64_t screen_last_frame_bytes(void)
+{
+    return last_frame_bytes;
+}
+
+uint64_t screen_total_bytes(void)
+{
+    return total_bytes;
+}
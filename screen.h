@@ -0,0 +1,79 @@
+#ifndef SCREEN_H
+#define SCREEN_H
+
+    #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#define _GNU_SOURCE
+    #endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include "delay.h"
+#include "fancy_text.h"
+
+#define SCREEN_MAX_ROWS (64)
+#define SCREEN_ROW_SIZE (128)
+// rows kept free under a frame for prompts & input: the hit/stand
+// prompt's two lines & the echoed answer. anything taller has to
+// screen_invalidate, or it could scroll the frame out of place.
+#define SCREEN_MARGIN (3)
+
+typedef enum ScreenEffect
+{
+    EFFECT_NONE = 0, // text is printed, staggered by the row's delay
+    EFFECT_FLASH = 1, // text is flashed using flash_text
+    EFFECT_RUN_UP = 2 // trailing number is counted up using run_up_number_2d
+} ScreenEffect;
+
+typedef struct ScreenRow
+{
+    char text[SCREEN_ROW_SIZE];
+    uint16_t length;
+    uint16_t delay; // per-character stagger
+    uint16_t pause; // wait before the row is drawn
+    ScreenEffect effect;
+    uint8_t flash_reps;
+    uint32_t flash_delay;
+    uint16_t run_up_offset;
+    uint16_t run_up_delay;
+    uint32_t run_up_number;
+    uint32_t run_up_drama;
+} ScreenRow;
+
+// ** SCREEN FUNCTIONS **
+// a frame is composed row by row into a back buffer and then presented,
+// which compares it to what is already on the terminal (front buffer)
+// and only redraws the rows (or row tails) that changed.
+// animations & pauses attached to a row only play when the row is redrawn.
+// outside of a frame, all of the text functions print straight through.
+
+// starts composing a new frame
+void screen_begin(void);
+// appends text to the frame, staggered by delay when drawn
+void screen_text(uint16_t delay, const char *text);
+// appends a known-length text to the frame
+void screen_write(const char *text, size_t length);
+// appends formatted text to the frame
+void screen_printf(const char *format, ...);
+// waits before drawing the current row
+void screen_pause(uint16_t ms);
+// appends text that flashes when drawn (see flash_text)
+void screen_flash(uint8_t reps, uint32_t delay, const char *text);
+// appends a number that counts up when drawn (see run_up_number_2d)
+void screen_run_up(uint16_t delay, uint32_t number, uint32_t dramaNumber);
+// draws the differences between the composed frame & the terminal,
+// leaving the cursor right under the frame
+void screen_present(void);
+// forgets what is on the terminal, so the next frame is fully redrawn.
+// needed whenever untracked output may have scrolled the terminal.
+void screen_invalidate(void);
+// number of frames presented so far
+uint32_t screen_frame_count(void);
+// bytes sent to the terminal by the last presented frame
+uint64_t screen_last_frame_bytes(void);
+// bytes sent to the terminal by all presented frames
+uint64_t screen_total_bytes(void);
+
+#endif
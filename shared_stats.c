@@ -0,0 +1,208 @@
+#include "shared_stats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "delay.h"
+
+static SharedStatsFile *stats = NULL;
+static SharedStatsSlot *own_slot = NULL;
+
+static bool process_alive(int32_t pid)
+{
+    return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+static SharedStatsFile *map_file(const char *path, bool create)
+{
+    struct stat info;
+
+    int fd = open(path, create ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (fd < 0) return NULL;
+
+    // every process may race to size a new file, which is harmless
+    if (fstat(fd, &info) != 0 || (create && info.st_size < (off_t)sizeof(SharedStatsFile)
+        && ftruncate(fd, sizeof(SharedStatsFile)) != 0))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    if (!create && info.st_size < (off_t)sizeof(SharedStatsFile))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    SharedStatsFile *file = mmap(NULL, sizeof(SharedStatsFile), create ? PROT_READ | PROT_WRITE : PROT_READ,
+        MAP_SHARED, fd, 0);
+    close(fd);
+
+    return file == MAP_FAILED ? NULL : file;
+}
+
+// a file another process has only just created may not have its header yet,
+// so a zero magic is waited on for a while before the file counts as bad
+static bool header_valid(const SharedStatsHeader *header)
+{
+    struct timespec pause = { 0, 1000000 };
+    uint32_t magic = __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE);
+
+    for (int waited = 0; magic == 0 && waited < SHARED_STATS_HEADER_WAIT_MS; waited++)
+    {
+        nanosleep(&pause, NULL);
+        magic = __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE);
+    }
+
+    return magic == SHARED_STATS_MAGIC
+        && header->version == SHARED_STATS_VERSION
+        && header->slot_count == SHARED_STATS_SLOTS
+        && header->slot_size == sizeof(SharedStatsSlot);
+}
+
+bool shared_stats_open(const char *path)
+{
+    int32_t pid = (int32_t)getpid();
+
+    stats = map_file(path, true);
+    if (stats == NULL) return false;
+
+    // concurrent creators all write the same header,
+    // with the magic going in last
+    if (__atomic_load_n(&stats->header.magic, __ATOMIC_ACQUIRE) == 0)
+    {
+        stats->header.version = SHARED_STATS_VERSION;
+        stats->header.slot_count = SHARED_STATS_SLOTS;
+        stats->header.slot_size = sizeof(SharedStatsSlot);
+        __atomic_store_n(&stats->header.magic, SHARED_STATS_MAGIC, __ATOMIC_RELEASE);
+    }
+
+    if (!header_valid(&stats->header))
+    {
+        shared_stats_close();
+        return false;
+    }
+
+    // claim a free slot, or one left behind by a process that has exited
+    for (int i = 0; i < SHARED_STATS_SLOTS && own_slot == NULL; i++)
+    {
+        int32_t owner = __atomic_load_n(&stats->slots[i].pid, __ATOMIC_RELAXED);
+
+        if ((owner == 0 || !process_alive(owner))
+            && __atomic_compare_exchange_n(&stats->slots[i].pid, &owner, pid, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            own_slot = &stats->slots[i];
+        }
+    }
+
+    // all slots busy: share one, the counters are atomic anyway
+    if (own_slot == NULL) own_slot = &stats->slots[pid % SHARED_STATS_SLOTS];
+
+    return true;
+}
+
+void shared_stats_bet(uint32_t amount)
+{
+    if (own_slot == NULL) return;
+    __atomic_fetch_add(&own_slot->bet, amount, __ATOMIC_RELAXED);
+}
+
+void shared_stats_outcome(RoundOutcome outcome, uint32_t paid)
+{
+    if (own_slot == NULL || outcome < OUTCOME_BROKE || outcome > OUTCOME_TIE) return;
+
+    if (outcome > OUTCOME_UNDECIDED) __atomic_fetch_add(&own_slot->rounds, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&own_slot->outcomes[outcome - OUTCOME_BROKE], 1, __ATOMIC_RELAXED);
+    if (paid) __atomic_fetch_add(&own_slot->paid, paid, __ATOMIC_RELAXED);
+}
+
+void shared_stats_close(void)
+{
+    if (stats != NULL) munmap(stats, sizeof(SharedStatsFile));
+    stats = NULL;
+    own_slot = NULL;
+}
+
+int shared_stats_main(int argc, char *argv[])
+{
+    static const char *outcome_names[SHARED_STATS_OUTCOMES] =
+    {
+        "Broke:", "Quit:", "Undecided:", "Blackjack:", "Win:", "Lose:", "Tie:"
+    };
+    bool once = false;
+    const char *path = NULL;
+
+    for (int i = 0; i < argc; i++)
+    {
+        if (strcmp("--once", argv[i]) == 0) once = true;
+        else path = argv[i];
+    }
+
+    if (path == NULL)
+    {
+        printf("Usage: prog stats <stats file> [--once]\n");
+        return 1;
+    }
+
+    SharedStatsFile *file = map_file(path, false);
+    if (file == NULL || !header_valid(&file->header))
+    {
+        fprintf(stderr, "Could not read statistics file '%s'.\n", path);
+        if (file != NULL) munmap(file, sizeof(SharedStatsFile));
+        return 1;
+    }
+
+    for (;;)
+    {
+        SharedStatsSlot total;
+        uint32_t processes = 0;
+        uint32_t alive = 0;
+
+        memset(&total, 0, sizeof(total));
+
+        for (int i = 0; i < SHARED_STATS_SLOTS; i++)
+        {
+            const SharedStatsSlot *slot = &file->slots[i];
+            int32_t pid = __atomic_load_n(&slot->pid, __ATOMIC_RELAXED);
+            if (pid == 0) continue;
+
+            processes++;
+            alive += process_alive(pid);
+            total.rounds += __atomic_load_n(&slot->rounds, __ATOMIC_RELAXED);
+            total.bet += __atomic_load_n(&slot->bet, __ATOMIC_RELAXED);
+            total.paid += __atomic_load_n(&slot->paid, __ATOMIC_RELAXED);
+            for (int o = 0; o < SHARED_STATS_OUTCOMES; o++)
+            {
+                total.outcomes[o] += __atomic_load_n(&slot->outcomes[o], __ATOMIC_RELAXED);
+            }
+        }
+
+        if (!once) printf("\x1b[H\x1b[J");
+        printf("=======  BLACKJACK  =======\n\n");
+        printf("Processes:  %u running, %u slots used\n", alive, processes);
+        printf("Rounds:     %llu\n", (unsigned long long)total.rounds);
+        for (int o = 0; o < SHARED_STATS_OUTCOMES; o++)
+        {
+            if (o - 2 == OUTCOME_UNDECIDED) continue;
+            printf("%-11s %llu\n", outcome_names[o], (unsigned long long)total.outcomes[o]);
+        }
+        printf("Bet:        $%llu\n", (unsigned long long)total.bet);
+        printf("Paid out:   $%llu\n", (unsigned long long)total.paid);
+        printf("House:      $%lld\n", (long long)(total.bet - total.paid));
+        fflush(stdout);
+
+        if (once) break;
+        delay_ms(1000);
+    }
+
+    munmap(file, sizeof(SharedStatsFile));
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+#ifndef SHARED_STATS_H
+#define SHARED_STATS_H
+
+    #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#define _GNU_SOURCE
+    #endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_structs.h"
+
+#define SHARED_STATS_VERSION (2)
+// "BJST" in memory order on a little-endian host
+#define SHARED_STATS_MAGIC (0x54534a42u)
+// how long a reader waits for a new file's header to be published
+#define SHARED_STATS_HEADER_WAIT_MS (1000)
+#define SHARED_STATS_SLOTS (256)
+#define CACHE_LINE_SIZE (64)
+// RoundOutcome values run from OUTCOME_BROKE (-2) to OUTCOME_TIE (4)
+#define SHARED_STATS_OUTCOMES (7)
+
+// the magic is published last, with a single atomic store,
+// so a non-zero magic means the rest of the header is in place
+typedef struct SharedStatsHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;
+} __attribute__((aligned(CACHE_LINE_SIZE))) SharedStatsHeader;
+
+// one per process, padded so that no two processes write the same cache line.
+// a slot outlives its process: counts are house-wide totals,
+// and a slot whose owner has died is taken over by the next process.
+typedef struct SharedStatsSlot
+{
+    int32_t pid; // owner, 0 if never used
+    uint32_t reserved;
+    uint64_t rounds;
+    uint64_t outcomes[SHARED_STATS_OUTCOMES]; // indexed by RoundOutcome + 2
+    uint64_t bet; // money put into the pot
+    uint64_t paid; // money paid out of the pot
+} __attribute__((aligned(CACHE_LINE_SIZE))) SharedStatsSlot;
+
+typedef struct SharedStatsFile
+{
+    SharedStatsHeader header;
+    SharedStatsSlot slots[SHARED_STATS_SLOTS];
+} SharedStatsFile;
+
+// ** SHARED STATS FUNCTIONS **
+// maps (creating if needed) a statistics file & claims a slot in it
+bool shared_stats_open(const char *path);
+// counts money put into the pot
+void shared_stats_bet(uint32_t amount);
+// counts a round outcome & the money paid out for it
+void shared_stats_outcome(RoundOutcome outcome, uint32_t paid);
+// unmaps the statistics file (the slot keeps its counts)
+void shared_stats_close(void);
+// "stats" subcommand: shows the totals of all processes, refreshed live
+int shared_stats_main(int argc, char *argv[]);
+
+#endif
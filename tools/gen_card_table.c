@@ -0,0 +1,82 @@
+// build-time generator for card_table.c.
+// writes a table indexed by the packed card byte
+// (rank in the high nibble, one-hot suit in the low nibble)
+// holding each card's fully formatted line, its length & blackjack value,
+// so the game never decodes or printf's a card at runtime.
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#define NUM_RANKS (13)
+#define NUM_SUITS (4)
+#define TEXT_SIZE (32)
+
+const char suit_symbols[NUM_SUITS][4] =
+{
+    "♥", "♣", "♦", "♠"
+};
+
+const char suit_names[NUM_SUITS][8] =
+{
+    "Hearts ", "Clubs  ", "Diamond", "Spades "
+};
+
+const char rank_symbols[NUM_RANKS][3] =
+{
+    " A", " 2", " 3", " 4", " 5", " 6", " 7",
+    " 8", " 9", "10", " J", " Q", " K"
+};
+
+const char rank_names[NUM_RANKS][6] =
+{
+    "  Ace", "  Two", "Three", " Four", " Five", "  Six", "Seven",
+    "Eight", " Nine", "  Ten", " Jack", "Queen", " King"
+};
+
+// prints a string as a C literal, escaping everything outside printable ascii
+static void print_literal(const char *text)
+{
+    printf("\"");
+    for (const unsigned char *c = (const unsigned char *)text; *c != '\0'; c++)
+    {
+        if (*c == '\n') printf("\\n");
+        else if (*c < 0x20 || *c >= 0x7F || *c == '"' || *c == '\\') printf("\\%03o", *c);
+        else printf("%c", *c);
+    }
+    printf("\"");
+}
+
+int main(void)
+{
+    char text[64];
+
+    printf("// generated by tools/gen_card_table.c, do not edit\n");
+    printf("#include \"card_funcs.h\"\n\n");
+    printf("const CardInfo card_table[256] =\n{\n");
+
+    for (int rankIdx = 0; rankIdx < NUM_RANKS; rankIdx++)
+    {
+        for (int suitIdx = 0; suitIdx < NUM_SUITS; suitIdx++)
+        {
+            uint8_t data = (uint8_t)((rankIdx << 4) | (1 << suitIdx));
+            int value = rankIdx + 1 > 10 ? 10 : rankIdx + 1;
+            int length = snprintf(text, sizeof(text), " [%s%s] %s of %s (%2d)\n",
+                rank_symbols[rankIdx], suit_symbols[suitIdx],
+                rank_names[rankIdx], suit_names[suitIdx], value);
+
+            if (length < 0 || length >= TEXT_SIZE)
+            {
+                fprintf(stderr, "card line too long: %d\n", length);
+                return 1;
+            }
+
+            printf("    [0x%02X] = { ", data);
+            print_literal(text);
+            printf(", %d, %d, %d, %d },\n", length, value, rankIdx, suitIdx);
+        }
+    }
+
+    printf("};\n");
+
+    return 0;
+}
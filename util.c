@@ -0,0 +1,84 @@
+#include "util.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+size_t put_uint(uint8_t *buf, uint64_t value, uint8_t bytes)
+{
+    for (uint8_t i = 0; i < bytes; i++)
+    {
+        buf[i] = (uint8_t)(value >> (8 * i));
+    }
+    return bytes;
+}
+
+uint64_t get_uint(const uint8_t *buf, uint8_t bytes)
+{
+    uint64_t value = 0;
+    for (uint8_t i = 0; i < bytes; i++)
+    {
+        value |= (uint64_t)buf[i] << (8 * i);
+    }
+    return value;
+}
+
+size_t put_double(uint8_t *buf, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return put_uint(buf, bits, 8);
+}
+
+double get_double(const uint8_t *buf)
+{
+    uint64_t bits = get_uint(buf, 8);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint32_t fnv1a(const void *data, size_t length)
+{
+    const uint8_t *bytes = data;
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+bool write_file_atomic(const char *path, const void *data, size_t size)
+{
+    char tmpPath[256];
+
+    if (snprintf(tmpPath, sizeof(tmpPath), "%s.%ld.tmp", path, (long)getpid()) >= (int)sizeof(tmpPath)) return false;
+
+    FILE *file = fopen(tmpPath, "wb");
+    if (file == NULL) return false;
+
+    bool ok = fwrite(data, 1, size, file) == size
+        && fflush(file) == 0
+        && fsync(fileno(file)) == 0;
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok || rename(tmpPath, path) != 0)
+    {
+        remove(tmpPath);
+        return false;
+    }
+
+    return true;
+}
+
+uint64_t now_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
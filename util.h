@@ -0,0 +1,34 @@
+#ifndef UTIL_H
+#define UTIL_H
+
+    #if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#define _GNU_SOURCE
+    #endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// ** BYTE ORDER **
+// files meant to move between machines store every multi-byte field
+// little-endian regardless of host, doubles by their IEEE-754 bits.
+// the put functions return the number of bytes written.
+
+size_t put_uint(uint8_t *buf, uint64_t value, uint8_t bytes);
+uint64_t get_uint(const uint8_t *buf, uint8_t bytes);
+size_t put_double(uint8_t *buf, double value);
+double get_double(const uint8_t *buf);
+
+// ** FILES **
+// FNV-1a of a buffer, enough to catch truncated or corrupted data
+uint32_t fnv1a(const void *data, size_t length);
+// replaces a file with data: it is written under a temporary name
+// (unique per process), synced & then renamed over path,
+// so a crash never leaves a half-written file behind
+bool write_file_atomic(const char *path, const void *data, size_t size);
+
+// ** TIME **
+// monotonic clock in microseconds
+uint64_t now_us(void);
+
+#endif